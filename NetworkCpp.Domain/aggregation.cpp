@@ -0,0 +1,100 @@
+#include "aggregation.h"
+
+#include <stdexcept>
+
+aggregation::ReceiveAggregator::ReceiveAggregator(const std::size_t window, const double sampleRate,
+	const std::uint64_t seed, const double resolution, const int precision)
+	: m_window(window), m_sampleRate(sampleRate), m_resolution(resolution), m_rng(seed), m_count(0), m_bytes(0),
+	m_sampled(0), m_latency(precision), m_next(0) {
+	if (sampleRate < 0 || sampleRate > 1) {
+		throw std::invalid_argument("sample rate should be between zero and one");
+	}
+
+	if (resolution <= 0) {
+		throw std::invalid_argument("latency resolution should be positive");
+	}
+
+	m_recent.reserve(window);
+}
+
+void aggregation::ReceiveAggregator::add(const entities::Message& message) {
+	m_count++;
+	m_bytes += message.size() > 0 ? message.size() : 0;
+
+	auto& totals = m_senders.emplace(message.sender().id(), Totals{ 0, 0 }).first->second;
+	totals.count++;
+	totals.bytes += message.size() > 0 ? message.size() : 0;
+
+	const auto latency = message.latency();
+	m_latency.record(latency > 0 ? static_cast<std::uint64_t>(latency / m_resolution + 0.5) : 0);
+
+	// totals see every delivery, only the kept window is sampled
+	if (m_window == 0 || (m_sampleRate < 1 && m_rng.nextUnit() >= m_sampleRate)) {
+		return;
+	}
+
+	m_sampled++;
+	if (m_recent.size() < m_window) {
+		m_recent.push_back(message);
+		return;
+	}
+
+	m_recent[m_next] = message;
+	m_next = m_next + 1 == m_window ? 0 : m_next + 1;
+}
+
+void aggregation::ReceiveAggregator::clear() {
+	m_count = 0;
+	m_bytes = 0;
+	m_sampled = 0;
+	m_senders.clear();
+	m_latency.clear();
+	m_recent.clear();
+	m_next = 0;
+}
+
+std::uint64_t aggregation::ReceiveAggregator::count() const {
+	return m_count;
+}
+
+std::uint64_t aggregation::ReceiveAggregator::bytes() const {
+	return m_bytes;
+}
+
+std::size_t aggregation::ReceiveAggregator::senderCount() const {
+	return m_senders.size();
+}
+
+aggregation::Totals aggregation::ReceiveAggregator::sender(const boost::uuids::uuid& id) const {
+	const auto totals = m_senders.find(id);
+	return totals == m_senders.end() ? Totals{ 0, 0 } : totals->second;
+}
+
+double aggregation::ReceiveAggregator::resolution() const {
+	return m_resolution;
+}
+
+const metrics::LatencyHistogram& aggregation::ReceiveAggregator::latency() const {
+	return m_latency;
+}
+
+std::size_t aggregation::ReceiveAggregator::window() const {
+	return m_window;
+}
+
+double aggregation::ReceiveAggregator::sampleRate() const {
+	return m_sampleRate;
+}
+
+std::uint64_t aggregation::ReceiveAggregator::sampled() const {
+	return m_sampled;
+}
+
+std::vector<entities::Message> aggregation::ReceiveAggregator::recent() const {
+	// oldest first, the ring only wraps once it is full
+	std::vector<entities::Message> recent;
+	recent.reserve(m_recent.size());
+	recent.insert(recent.end(), m_recent.begin() + m_next, m_recent.end());
+	recent.insert(recent.end(), m_recent.begin(), m_recent.begin() + m_next);
+	return recent;
+}
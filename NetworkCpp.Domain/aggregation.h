@@ -0,0 +1,59 @@
+#ifndef _AGGREGATION_H_
+#define _AGGREGATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "entities.h"
+#include "metrics.h"
+#include "rng.h"
+
+namespace aggregation {
+	struct Totals {
+		std::uint64_t								count;
+		std::uint64_t								bytes;
+	};
+
+	class ReceiveAggregator {
+	public:
+		explicit ReceiveAggregator(std::size_t window = 0, double sampleRate = 1.0, std::uint64_t seed = 0,
+			double resolution = 1e-9, int precision = 7);
+
+		void										add(const entities::Message& message);
+		void										clear();
+
+		std::uint64_t								count() const;
+		std::uint64_t								bytes() const;
+		std::size_t									senderCount() const;
+		Totals										sender(const boost::uuids::uuid& id) const;
+
+		double										resolution() const;
+		const metrics::LatencyHistogram&			latency() const;
+
+		std::size_t									window() const;
+		double										sampleRate() const;
+		std::uint64_t								sampled() const;
+		std::vector<entities::Message>				recent() const;
+
+	private:
+		const std::size_t							m_window;
+		const double								m_sampleRate;
+		const double								m_resolution;
+		rng::Xoshiro256								m_rng;
+
+		std::uint64_t								m_count;
+		std::uint64_t								m_bytes;
+		std::uint64_t								m_sampled;
+		std::unordered_map<boost::uuids::uuid, Totals, boost::hash<boost::uuids::uuid>>	m_senders;
+		metrics::LatencyHistogram					m_latency;
+
+		std::vector<entities::Message>				m_recent;
+		std::size_t									m_next;
+	};
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _BITS_H_
+#define _BITS_H_
+
+#include <cstdint>
+
+namespace bits {
+	// index of the highest set bit, zero for zero, a binary search keeps it portable across compilers
+	inline int highest(std::uint64_t value) {
+		auto result = 0;
+		for (auto shift = 32; shift > 0; shift >>= 1) {
+			if (value >> shift) {
+				value >>= shift;
+				result += shift;
+			}
+		}
+		return result;
+	}
+}
+
+#endif
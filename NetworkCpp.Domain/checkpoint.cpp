@@ -0,0 +1,675 @@
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const char					magic[8] = { 'N', 'C', 'P', 'P', 'S', 'N', 'A', 'P' };
+	const std::uint32_t			byteOrder = 0x01020304;
+	const std::uint32_t			generatorFlag = 1;
+	const char					unactiveFlag = 1;
+	const char					compactFlag = 2;
+
+	const std::size_t			headerSize = 56;
+	const std::size_t			idSize = 16;
+	const std::size_t			messageSize = idSize + 4 * sizeof(std::uint32_t) + 2 * sizeof(double) + sizeof(std::uint64_t);
+	const std::size_t			channelSize = idSize + 2 + messageSize;
+	const std::size_t			engineCounters = 5;
+	const std::size_t			engineRecordSize = messageSize + 2 * sizeof(std::uint32_t) + sizeof(double);
+	const std::size_t			chunkSize = 1 << 16;
+
+	struct Header {
+		std::uint32_t			version;
+		std::uint32_t			byteOrder;
+		std::uint32_t			nodeCount;
+		std::uint32_t			foreignCount;
+		std::uint32_t			channelCount;
+		std::uint32_t			flags;
+		std::uint64_t			messageCount;
+		std::uint64_t			engineSize;
+		std::uint64_t			payloadSize;
+	};
+
+	static_assert(sizeof(magic) + sizeof(Header) == headerSize, "header should have no padding");
+
+	template<typename T>
+	T read(const char* data) {
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+	boost::uuids::uuid readId(const char* data) {
+		boost::uuids::uuid id;
+		std::memcpy(id.data, data, idSize);
+		return id;
+	}
+
+	// buffered messages first, then received ones, empty buffers are skipped so idle nodes get no storage
+	template<typename Function>
+	void forEachMessage(entities::Node& node, Function function) {
+		if (node.bufferedCount() > 0) {
+			if (node.isCompact()) {
+				std::for_each(node.compactBuffer().begin(), node.compactBuffer().end(), function);
+			}
+			else {
+				std::for_each(node.buffer().begin(), node.buffer().end(), function);
+			}
+		}
+
+		if (node.receivedCount() > 0) {
+			if (node.isCompact()) {
+				std::for_each(node.compactReceivedMessages().begin(), node.compactReceivedMessages().end(), function);
+			}
+			else {
+				std::for_each(node.receivedMessages().begin(), node.receivedMessages().end(), function);
+			}
+		}
+	}
+}
+
+checkpoint::SnapshotWriter::SnapshotWriter(const std::string& path)
+	: m_path(path), m_written(0), m_child(-1), m_pipe(-1), m_output(-1), m_payloadSize(0) {
+}
+
+checkpoint::SnapshotWriter::SnapshotWriter(SnapshotWriter&& writer)
+	: m_path(writer.m_path), m_stream(std::move(writer.m_stream)), m_image(std::move(writer.m_image)),
+	m_written(writer.m_written), m_child(writer.m_child), m_pipe(writer.m_pipe), m_output(-1), m_payloadSize(0) {
+	writer.m_child = -1;
+	writer.m_pipe = -1;
+}
+
+checkpoint::SnapshotWriter::~SnapshotWriter() {
+	abandon();
+}
+
+void checkpoint::SnapshotWriter::begin(std::vector<entities::Node>& nodes, const std::vector<entities::Channel*>& channels,
+	const traffic::TrafficGenerator* generator, const forwarding::ForwardingEngine* engine) {
+	// aggregated totals are not part of the format, a restored node would silently start from zero
+	for (const auto& node : nodes) {
+		if (node.aggregator()) {
+			throw std::invalid_argument("nodes with a receive aggregator cannot be snapshotted");
+		}
+	}
+
+	abandon();
+	m_written = 0;
+	m_stream = std::ofstream(m_path + ".partial", std::ios::binary | std::ios::trunc);
+	if (!m_stream) {
+		throw std::runtime_error("cannot open snapshot " + m_path);
+	}
+
+#if defined(__linux__)
+	// a forked child encodes its copy-on-write view of the state, so the caller only pauses for the fork and the
+	// snapshot never sits in memory as a whole
+	int pipes[2];
+	if (pipe(pipes) != 0) {
+		abandon();
+		throw std::runtime_error("cannot start snapshot " + m_path);
+	}
+
+	const auto child = fork();
+	if (child == 0) {
+		close(pipes[0]);
+		m_output = pipes[1];
+		try {
+			encode(nodes, channels, generator, engine);
+			_exit(0);
+		}
+		catch (...) {
+			_exit(1);
+		}
+	}
+
+	close(pipes[1]);
+	m_pipe = pipes[0];
+	if (child < 0) {
+		abandon();
+		throw std::runtime_error("cannot start snapshot " + m_path);
+	}
+	m_child = child;
+#else
+	encode(nodes, channels, generator, engine);
+#endif
+}
+
+bool checkpoint::SnapshotWriter::step(const std::size_t bytes) {
+	if (isFinished()) {
+		return true;
+	}
+
+#if defined(__linux__)
+	// a step moves at most the requested bytes from the child to disk, the end of the pipe means the child is done
+	m_image.resize(chunkSize);
+	for (std::size_t moved = 0; moved < bytes;) {
+		const auto length = ::read(m_pipe, m_image.data(), std::min(bytes - moved, m_image.size()));
+		if (length < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (length == 0) {
+			int status = 0;
+			waitpid(m_child, &status, 0);
+			m_child = -1;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				abandon();
+				throw std::runtime_error("cannot encode snapshot " + m_path);
+			}
+
+			finish();
+			return true;
+		}
+
+		m_stream.write(m_image.data(), length > 0 ? length : 0);
+		if (length < 0 || !m_stream) {
+			abandon();
+			throw std::runtime_error("cannot write snapshot " + m_path);
+		}
+		moved += length;
+		m_written += length;
+	}
+
+	return false;
+#else
+	const auto length = std::min(bytes, m_image.size() - m_written);
+	m_stream.write(m_image.data() + m_written, length);
+	m_written += length;
+
+	if (!m_stream) {
+		abandon();
+		throw std::runtime_error("cannot write snapshot " + m_path);
+	}
+
+	if (m_written < m_image.size()) {
+		return false;
+	}
+
+	finish();
+	return true;
+#endif
+}
+
+void checkpoint::SnapshotWriter::write(std::vector<entities::Node>& nodes, const std::vector<entities::Channel*>& channels,
+	const traffic::TrafficGenerator* generator, const forwarding::ForwardingEngine* engine) {
+	begin(nodes, channels, generator, engine);
+	while (!step(chunkSize)) {
+	}
+}
+
+bool checkpoint::SnapshotWriter::isFinished() const {
+	return !m_stream.is_open();
+}
+
+void checkpoint::SnapshotWriter::encode(std::vector<entities::Node>& nodes, const std::vector<entities::Channel*>& channels,
+	const traffic::TrafficGenerator* generator, const forwarding::ForwardingEngine* engine) {
+	m_image.clear();
+	m_indices.clear();
+	m_foreign.clear();
+	m_payloadSize = 0;
+
+	const auto state = engine != nullptr ? engine->state() : forwarding::State();
+	std::uint64_t payloadSize = 0;
+	const auto number = [this, &payloadSize](const entities::Message& message) {
+		indexOf(message.sender());
+		indexOf(message.receiver());
+		payloadSize += message.payload().size();
+	};
+
+	// endpoints outside the node table are numbered up front, since the header counts them before any message
+	m_indices.reserve(nodes.size());
+	for (auto& node : nodes) {
+		m_indices.emplace(node.id(), static_cast<std::uint32_t>(m_indices.size()));
+	}
+
+	std::uint64_t messageCount = 0;
+	for (auto& node : nodes) {
+		messageCount += node.bufferedCount() + node.receivedCount();
+		forEachMessage(node, number);
+	}
+
+	for (auto channel : channels) {
+		const auto oneWay = dynamic_cast<const entities::OneWayChannel*>(channel);
+		if (oneWay != nullptr && !oneWay->isEmpty()) {
+			number(oneWay->peek());
+		}
+	}
+	std::for_each(state.messages.begin(), state.messages.end(), number);
+
+	auto header = Header();
+	header.version = formatVersion;
+	header.byteOrder = byteOrder;
+	header.nodeCount = static_cast<std::uint32_t>(nodes.size());
+	header.foreignCount = static_cast<std::uint32_t>(m_foreign.size());
+	header.channelCount = static_cast<std::uint32_t>(channels.size());
+	header.flags = generator != nullptr ? generatorFlag : 0;
+	header.messageCount = messageCount;
+	header.engineSize = engine != nullptr
+		? sizeof(double) + (engineCounters + 2) * sizeof(std::uint64_t) + state.messages.size() * engineRecordSize
+		: 0;
+	header.payloadSize = payloadSize;
+
+	append(magic, sizeof(magic));
+	append(&header, sizeof(header));
+
+	for (auto& node : nodes) {
+		const auto id = node.id();
+		append(id.data, idSize);
+	}
+
+	for (auto& node : nodes) {
+		const auto flags = static_cast<char>((node.isUnactive() ? unactiveFlag : 0) | (node.isCompact() ? compactFlag : 0));
+		append(&flags, 1);
+	}
+
+	for (auto& node : nodes) {
+		const std::uint32_t counts[] = {
+			static_cast<std::uint32_t>(node.bufferedCount()),
+			static_cast<std::uint32_t>(node.receivedCount())
+		};
+		append(counts, sizeof(counts));
+	}
+
+	for (auto& node : nodes) {
+		forEachMessage(node, [this](const entities::Message& message) {
+			appendMessage(message);
+		});
+	}
+
+	for (auto channel : channels) {
+		const auto id = channel->id();
+		append(id.data, idSize);
+
+		const auto oneWay = dynamic_cast<const entities::OneWayChannel*>(channel);
+		const char flags[] = { static_cast<char>(channel->isBusy()), static_cast<char>(oneWay != nullptr && !oneWay->isEmpty()) };
+		append(flags, sizeof(flags));
+
+		if (flags[1]) {
+			appendMessage(oneWay->peek());
+		}
+		else {
+			const char empty[messageSize] = {};
+			append(empty, messageSize);
+		}
+	}
+
+	// packets still queued or crossing a link
+	if (engine != nullptr) {
+		const std::uint64_t sizes[] = { state.messages.size(), state.landing };
+
+		append(&state.time, sizeof(double));
+		append(state.counters.data(), engineCounters * sizeof(std::uint64_t));
+		append(sizes, sizeof(sizes));
+		for (std::size_t i = 0; i < state.messages.size(); i++) {
+			appendMessage(state.messages[i]);
+			const std::uint32_t placement[] = { state.destinations[i], state.places[i] };
+			append(placement, sizeof(placement));
+			append(&state.queuedAt[i], sizeof(double));
+		}
+	}
+
+	for (const auto& id : m_foreign) {
+		append(id.data, idSize);
+	}
+
+	// payload bytes follow in the same message order, so each record only holds its offset into this section
+	const auto appendPayload = [this](const entities::Message& message) {
+		message.payload().forEach([this](const unsigned char* data, const std::size_t size) {
+			append(data, size);
+		});
+	};
+
+	for (auto& node : nodes) {
+		forEachMessage(node, appendPayload);
+	}
+
+	for (auto channel : channels) {
+		const auto oneWay = dynamic_cast<const entities::OneWayChannel*>(channel);
+		if (oneWay != nullptr && !oneWay->isEmpty()) {
+			appendPayload(oneWay->peek());
+		}
+	}
+	std::for_each(state.messages.begin(), state.messages.end(), appendPayload);
+
+	if (generator != nullptr) {
+		std::vector<std::uint64_t> rngState;
+		std::vector<double> processState;
+		generator->state(rngState, processState);
+
+		const std::uint32_t sizes[] = {
+			static_cast<std::uint32_t>(rngState.size()),
+			static_cast<std::uint32_t>(processState.size())
+		};
+		append(&sizes[0], sizeof(std::uint32_t));
+		append(rngState.data(), rngState.size() * sizeof(std::uint64_t));
+		append(&sizes[1], sizeof(std::uint32_t));
+		append(processState.data(), processState.size() * sizeof(double));
+	}
+
+	flush();
+}
+
+void checkpoint::SnapshotWriter::finish() {
+	m_stream.close();
+	m_image.clear();
+	m_image.shrink_to_fit();
+
+	// the new file replaces the old one in a single step, there is never a moment without a complete snapshot
+	const auto partial = m_path + ".partial";
+#if defined(_WIN32)
+	const auto isReplaced = MoveFileExA(partial.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const auto isReplaced = std::rename(partial.c_str(), m_path.c_str()) == 0;
+#endif
+	if (!isReplaced) {
+		throw std::runtime_error("cannot finalize snapshot " + m_path);
+	}
+}
+
+void checkpoint::SnapshotWriter::abandon() {
+#if defined(__linux__)
+	if (m_pipe >= 0) {
+		close(m_pipe);
+		m_pipe = -1;
+	}
+
+	if (m_child > 0) {
+		int status = 0;
+		kill(m_child, SIGKILL);
+		waitpid(m_child, &status, 0);
+		m_child = -1;
+	}
+#endif
+
+	// an unfinished snapshot is dropped, the previous one stays in place
+	if (m_stream.is_open()) {
+		m_stream.close();
+		std::remove((m_path + ".partial").c_str());
+	}
+	m_image.clear();
+}
+
+std::uint32_t checkpoint::SnapshotWriter::indexOf(const entities::Node& node) {
+	const auto id = node.id();
+	auto iterator = m_indices.find(id);
+	if (iterator != m_indices.end()) {
+		return iterator->second;
+	}
+
+	const auto index = static_cast<std::uint32_t>(m_indices.size());
+	m_indices.emplace(id, index);
+	m_foreign.push_back(id);
+	return index;
+}
+
+void checkpoint::SnapshotWriter::append(const void* data, const std::size_t size) {
+	const auto bytes = static_cast<const char*>(data);
+	m_image.insert(m_image.end(), bytes, bytes + size);
+	if (m_output >= 0 && m_image.size() >= chunkSize) {
+		flush();
+	}
+}
+
+void checkpoint::SnapshotWriter::appendMessage(const entities::Message& message) {
+	const auto id = message.id();
+	append(id.data, idSize);
+
+	const auto payloadSize = message.payload().size();
+	if (payloadSize > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::invalid_argument("message payload is too large to be snapshotted");
+	}
+
+	const std::uint32_t fields[] = {
+		static_cast<std::uint32_t>(message.size()),
+		indexOf(message.sender()),
+		indexOf(message.receiver()),
+		static_cast<std::uint32_t>(payloadSize)
+	};
+	append(fields, sizeof(fields));
+
+	const double times[] = { message.sentAt(), message.receivedAt() };
+	append(times, sizeof(times));
+
+	append(&m_payloadSize, sizeof(std::uint64_t));
+	m_payloadSize += payloadSize;
+}
+
+void checkpoint::SnapshotWriter::flush() {
+#if defined(__linux__)
+	if (m_output < 0) {
+		return;
+	}
+
+	for (std::size_t sent = 0; sent < m_image.size();) {
+		const auto length = ::write(m_output, m_image.data() + sent, m_image.size() - sent);
+		if (length < 0 && errno != EINTR) {
+			throw std::runtime_error("cannot stream snapshot " + m_path);
+		}
+		sent += length > 0 ? length : 0;
+	}
+	m_image.clear();
+#endif
+}
+
+checkpoint::Snapshot::Snapshot(const std::string& path)
+	: m_file(path.c_str(), boost::interprocess::read_only), m_region(m_file, boost::interprocess::read_only) {
+	m_data = static_cast<const char*>(m_region.get_address());
+	m_size = m_region.get_size();
+
+	if (m_size < headerSize || std::memcmp(m_data, magic, sizeof(magic)) != 0) {
+		throw std::runtime_error("not a snapshot: " + path);
+	}
+
+	const auto header = read<Header>(m_data + sizeof(magic));
+	if (header.byteOrder != byteOrder || header.version != formatVersion) {
+		throw std::runtime_error("snapshot has an unsupported format: " + path);
+	}
+
+	m_nodeCount = header.nodeCount;
+	m_foreignCount = header.foreignCount;
+	m_channelCount = header.channelCount;
+	m_messageCount = header.messageCount;
+	m_engineSize = header.engineSize;
+	m_payloadSize = header.payloadSize;
+	m_hasGenerator = (header.flags & generatorFlag) != 0;
+
+	m_idsOffset = headerSize;
+	m_flagsOffset = m_idsOffset + std::size_t(m_nodeCount) * idSize;
+	m_countsOffset = m_flagsOffset + m_nodeCount;
+	m_messagesOffset = m_countsOffset + std::size_t(m_nodeCount) * 2 * sizeof(std::uint32_t);
+	m_channelsOffset = m_messagesOffset + std::size_t(m_messageCount) * messageSize;
+	m_engineOffset = m_channelsOffset + std::size_t(m_channelCount) * channelSize;
+	m_foreignOffset = m_engineOffset + static_cast<std::size_t>(m_engineSize);
+	m_payloadOffset = m_foreignOffset + std::size_t(m_foreignCount) * idSize;
+	m_generatorOffset = m_payloadOffset + static_cast<std::size_t>(m_payloadSize);
+
+	if (m_generatorOffset > m_size) {
+		throw std::runtime_error("snapshot is truncated: " + path);
+	}
+}
+
+std::uint32_t checkpoint::Snapshot::nodeCount() const {
+	return m_nodeCount;
+}
+
+std::uint32_t checkpoint::Snapshot::channelCount() const {
+	return m_channelCount;
+}
+
+bool checkpoint::Snapshot::hasGenerator() const {
+	return m_hasGenerator;
+}
+
+bool checkpoint::Snapshot::hasEngine() const {
+	return m_engineSize > 0;
+}
+
+std::vector<entities::Node> checkpoint::Snapshot::nodes() const {
+	std::vector<entities::Node> nodes;
+	nodes.reserve(m_nodeCount);
+
+	for (std::uint32_t i = 0; i < m_nodeCount; i++) {
+		const auto flags = *at(m_flagsOffset + i, 1);
+		nodes.emplace_back(readId(at(m_idsOffset + i * idSize, idSize)));
+		nodes.back().setIsUnactive((flags & unactiveFlag) != 0);
+		nodes.back().setIsCompact((flags & compactFlag) != 0);
+	}
+
+	const auto shared = endpoints();
+	auto offset = m_messagesOffset;
+
+	for (std::uint32_t i = 0; i < m_nodeCount; i++) {
+		const auto counts = at(m_countsOffset + i * 2 * sizeof(std::uint32_t), 2 * sizeof(std::uint32_t));
+		const auto buffered = read<std::uint32_t>(counts);
+		const auto received = read<std::uint32_t>(counts + sizeof(std::uint32_t));
+
+		for (std::uint32_t j = 0; j < buffered; j++, offset += messageSize) {
+			nodes[i].send(readMessage(offset, shared));
+		}
+
+		for (std::uint32_t j = 0; j < received; j++, offset += messageSize) {
+			nodes[i].receive(readMessage(offset, shared));
+		}
+	}
+
+	return nodes;
+}
+
+void checkpoint::Snapshot::restore(const std::vector<entities::Channel*>& channels) const {
+	if (channels.size() != m_channelCount) {
+		throw std::runtime_error("snapshot holds a different number of channels");
+	}
+
+	const auto shared = endpoints();
+
+	for (std::uint32_t i = 0; i < m_channelCount; i++) {
+		const auto offset = m_channelsOffset + i * channelSize;
+		const auto flags = at(offset + idSize, 2);
+
+		channels[i]->setIsBusy(flags[0] != 0);
+
+		auto oneWay = dynamic_cast<entities::OneWayChannel*>(channels[i]);
+		if (oneWay != nullptr && flags[1] != 0) {
+			oneWay->add(readMessage(offset + idSize + 2, shared));
+		}
+	}
+}
+
+void checkpoint::Snapshot::restore(traffic::TrafficGenerator& generator) const {
+	if (!m_hasGenerator) {
+		throw std::runtime_error("snapshot holds no generator state");
+	}
+
+	auto offset = m_generatorOffset;
+
+	std::vector<std::uint64_t> rngState(read<std::uint32_t>(at(offset, sizeof(std::uint32_t))));
+	offset += sizeof(std::uint32_t);
+	std::memcpy(rngState.data(), at(offset, rngState.size() * sizeof(std::uint64_t)), rngState.size() * sizeof(std::uint64_t));
+	offset += rngState.size() * sizeof(std::uint64_t);
+
+	std::vector<double> processState(read<std::uint32_t>(at(offset, sizeof(std::uint32_t))));
+	offset += sizeof(std::uint32_t);
+	std::memcpy(processState.data(), at(offset, processState.size() * sizeof(double)), processState.size() * sizeof(double));
+
+	generator.setState(rngState, processState);
+}
+
+void checkpoint::Snapshot::restore(forwarding::ForwardingEngine& engine) const {
+	if (!hasEngine()) {
+		throw std::runtime_error("snapshot holds no engine state");
+	}
+
+	auto offset = m_engineOffset;
+	auto state = forwarding::State();
+
+	state.time = read<double>(at(offset, sizeof(double)));
+	offset += sizeof(double);
+	state.counters.resize(engineCounters);
+	std::memcpy(state.counters.data(), at(offset, engineCounters * sizeof(std::uint64_t)), engineCounters * sizeof(std::uint64_t));
+	offset += engineCounters * sizeof(std::uint64_t);
+
+	const auto count = read<std::uint64_t>(at(offset, sizeof(std::uint64_t)));
+	state.landing = static_cast<std::size_t>(read<std::uint64_t>(at(offset + sizeof(std::uint64_t), sizeof(std::uint64_t))));
+	offset += 2 * sizeof(std::uint64_t);
+
+	if (offset + count * engineRecordSize != m_engineOffset + m_engineSize) {
+		throw std::runtime_error("snapshot engine state is inconsistent");
+	}
+
+	const auto shared = endpoints();
+	for (std::uint64_t i = 0; i < count; i++, offset += engineRecordSize) {
+		state.messages.push_back(readMessage(offset, shared));
+		state.destinations.push_back(read<std::uint32_t>(at(offset + messageSize, sizeof(std::uint32_t))));
+		state.places.push_back(read<std::uint32_t>(at(offset + messageSize + sizeof(std::uint32_t), sizeof(std::uint32_t))));
+		state.queuedAt.push_back(read<double>(at(offset + messageSize + 2 * sizeof(std::uint32_t), sizeof(double))));
+	}
+
+	engine.setState(state);
+}
+
+const char* checkpoint::Snapshot::at(const std::size_t offset, const std::size_t size) const {
+	if (offset + size > m_size) {
+		throw std::runtime_error("snapshot is truncated");
+	}
+
+	return m_data + offset;
+}
+
+std::vector<std::shared_ptr<const entities::Node>> checkpoint::Snapshot::endpoints() const {
+	// messages only need their endpoints' identity, so every message shares one bare node per index
+	std::vector<std::shared_ptr<const entities::Node>> endpoints;
+	endpoints.reserve(std::size_t(m_nodeCount) + m_foreignCount);
+
+	for (std::uint32_t i = 0; i < m_nodeCount; i++) {
+		endpoints.push_back(std::make_shared<const entities::Node>(readId(at(m_idsOffset + i * idSize, idSize))));
+	}
+
+	for (std::uint32_t i = 0; i < m_foreignCount; i++) {
+		endpoints.push_back(std::make_shared<const entities::Node>(readId(at(m_foreignOffset + i * idSize, idSize))));
+	}
+
+	return endpoints;
+}
+
+entities::Message checkpoint::Snapshot::readMessage(const std::size_t offset,
+	const std::vector<std::shared_ptr<const entities::Node>>& endpoints) const {
+	const auto record = at(offset, messageSize);
+	const auto size = read<std::uint32_t>(record + idSize);
+	const auto sender = read<std::uint32_t>(record + idSize + sizeof(std::uint32_t));
+	const auto receiver = read<std::uint32_t>(record + idSize + 2 * sizeof(std::uint32_t));
+	const auto payloadSize = read<std::uint32_t>(record + idSize + 3 * sizeof(std::uint32_t));
+	const auto payloadOffset = read<std::uint64_t>(record + idSize + 4 * sizeof(std::uint32_t) + 2 * sizeof(double));
+
+	if (sender >= endpoints.size() || receiver >= endpoints.size()) {
+		throw std::runtime_error("snapshot message refers to an unknown node");
+	}
+
+	auto message = entities::Message(readId(record), static_cast<int>(size), endpoints[sender], endpoints[receiver]);
+	message.setSentAt(read<double>(record + idSize + 4 * sizeof(std::uint32_t)));
+	message.setReceivedAt(read<double>(record + idSize + 4 * sizeof(std::uint32_t) + sizeof(double)));
+
+	if (payloadSize > 0) {
+		if (payloadOffset + payloadSize > m_payloadSize) {
+			throw std::runtime_error("snapshot message payload is out of bounds");
+		}
+
+		const auto data = at(m_payloadOffset + static_cast<std::size_t>(payloadOffset), payloadSize);
+		message.setPayload(payload::Payload(payload::SlabPool::shared().copyOf(data, payloadSize)));
+	}
+	return message;
+}
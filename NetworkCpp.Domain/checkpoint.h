@@ -0,0 +1,114 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "entities.h"
+#include "forwarding.h"
+#include "traffic.h"
+
+namespace checkpoint {
+	const std::uint32_t									formatVersion = 6;
+
+	class SnapshotWriter {
+	public:
+		explicit SnapshotWriter(const std::string& path);
+		SnapshotWriter(SnapshotWriter&& writer);
+
+		~SnapshotWriter();
+
+		void												begin(std::vector<entities::Node>& nodes,
+																const std::vector<entities::Channel*>& channels,
+																const traffic::TrafficGenerator* generator = nullptr,
+																const forwarding::ForwardingEngine* engine = nullptr);
+		bool												step(std::size_t bytes);
+		void												write(std::vector<entities::Node>& nodes,
+																const std::vector<entities::Channel*>& channels,
+																const traffic::TrafficGenerator* generator = nullptr,
+																const forwarding::ForwardingEngine* engine = nullptr);
+
+		bool												isFinished() const;
+
+	private:
+		const std::string									m_path;
+		std::ofstream										m_stream;
+		std::vector<char>									m_image;
+		std::size_t											m_written;
+		int													m_child;
+		int													m_pipe;
+		int													m_output;
+
+		std::unordered_map<boost::uuids::uuid, std::uint32_t, boost::hash<boost::uuids::uuid>>	m_indices;
+		std::vector<boost::uuids::uuid>						m_foreign;
+		std::uint64_t										m_payloadSize;
+
+		void												encode(std::vector<entities::Node>& nodes,
+																const std::vector<entities::Channel*>& channels,
+																const traffic::TrafficGenerator* generator,
+																const forwarding::ForwardingEngine* engine);
+		void												finish();
+		void												abandon();
+
+		std::uint32_t										indexOf(const entities::Node& node);
+		void												append(const void* data, std::size_t size);
+		void												appendMessage(const entities::Message& message);
+		void												flush();
+	};
+
+	class Snapshot {
+	public:
+		explicit Snapshot(const std::string& path);
+
+		std::uint32_t										nodeCount() const;
+		std::uint32_t										channelCount() const;
+		bool												hasGenerator() const;
+		bool												hasEngine() const;
+
+		std::vector<entities::Node>							nodes() const;
+		void												restore(const std::vector<entities::Channel*>& channels) const;
+		void												restore(traffic::TrafficGenerator& generator) const;
+		void												restore(forwarding::ForwardingEngine& engine) const;
+
+	private:
+		boost::interprocess::file_mapping					m_file;
+		boost::interprocess::mapped_region					m_region;
+
+		const char*											m_data;
+		std::size_t											m_size;
+
+		std::uint32_t										m_nodeCount;
+		std::uint32_t										m_foreignCount;
+		std::uint32_t										m_channelCount;
+		std::uint64_t										m_messageCount;
+		std::uint64_t										m_engineSize;
+		std::uint64_t										m_payloadSize;
+		bool												m_hasGenerator;
+
+		std::size_t											m_idsOffset;
+		std::size_t											m_flagsOffset;
+		std::size_t											m_foreignOffset;
+		std::size_t											m_countsOffset;
+		std::size_t											m_messagesOffset;
+		std::size_t											m_channelsOffset;
+		std::size_t											m_engineOffset;
+		std::size_t											m_payloadOffset;
+		std::size_t											m_generatorOffset;
+
+		const char*											at(std::size_t offset, std::size_t size) const;
+		std::vector<std::shared_ptr<const entities::Node>>	endpoints() const;
+		entities::Message									readMessage(std::size_t offset,
+																const std::vector<std::shared_ptr<const entities::Node>>& endpoints) const;
+	};
+}
+
+#endif
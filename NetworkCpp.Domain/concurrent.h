@@ -0,0 +1,187 @@
+#ifndef _CONCURRENT_H_
+#define _CONCURRENT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "entities.h"
+
+namespace concurrent {
+	const std::size_t cacheLineSize = 64;
+
+	constexpr std::size_t roundUpToPowerOfTwo(const std::size_t value, const std::size_t power = 1) {
+		return power >= value ? power : roundUpToPowerOfTwo(value, power * 2);
+	}
+
+	template<typename T, int size>
+	class BoundedQueue {
+		static_assert(size > 0, "Size should non-negative and not zero");
+	public:
+		static const std::size_t					capacity = roundUpToPowerOfTwo(size);
+
+		BoundedQueue();
+		BoundedQueue(const BoundedQueue&) = delete;
+
+		~BoundedQueue();
+
+		const BoundedQueue&							operator=(const BoundedQueue&) = delete;
+
+		bool										tryAdd(const T& item);
+		bool										tryTake(T& item);
+
+		std::size_t									addBatch(const T* items, std::size_t count);
+		std::size_t									takeBatch(T* items, std::size_t count);
+
+		std::size_t									count() const;
+		bool										isEmpty() const;
+		bool										isFilled() const;
+
+	private:
+		static const std::size_t					mask = capacity - 1;
+
+		struct Cell {
+			std::atomic<std::size_t>							sequence;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type	storage;
+		};
+
+		std::unique_ptr<Cell[]>						m_cells;
+
+		alignas(cacheLineSize) std::atomic<std::size_t>	m_enqueuePosition;
+		alignas(cacheLineSize) std::atomic<std::size_t>	m_dequeuePosition;
+		char										m_padding[cacheLineSize - sizeof(std::atomic<std::size_t>)];
+
+		T*											itemAt(Cell& cell);
+		std::size_t									claim(std::atomic<std::size_t>& position, std::size_t lag, std::size_t count,
+														std::size_t& start);
+	};
+
+	template<int size = 1024>
+	using ConcurrentMessageBuffer = BoundedQueue<entities::Message, size>;
+
+	template <typename T, int size>
+	const std::size_t BoundedQueue<T, size>::capacity;
+
+	template <typename T, int size>
+	const std::size_t BoundedQueue<T, size>::mask;
+
+	template <typename T, int size>
+	BoundedQueue<T, size>::BoundedQueue()
+		: m_cells(new Cell[capacity]), m_enqueuePosition(0), m_dequeuePosition(0) {
+		for (std::size_t i = 0; i < capacity; i++) {
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template <typename T, int size>
+	BoundedQueue<T, size>::~BoundedQueue() {
+		const auto end = m_enqueuePosition.load(std::memory_order_relaxed);
+		for (auto position = m_dequeuePosition.load(std::memory_order_relaxed); position != end; position++) {
+			itemAt(m_cells[position & mask])->~T();
+		}
+	}
+
+	template <typename T, int size>
+	bool BoundedQueue<T, size>::tryAdd(const T& item) {
+		return addBatch(&item, 1) == 1;
+	}
+
+	template <typename T, int size>
+	bool BoundedQueue<T, size>::tryTake(T& item) {
+		return takeBatch(&item, 1) == 1;
+	}
+
+	template <typename T, int size>
+	std::size_t BoundedQueue<T, size>::addBatch(const T* items, const std::size_t count) {
+		std::size_t start;
+		const auto claimed = claim(m_enqueuePosition, 0, count, start);
+
+		for (std::size_t i = 0; i < claimed; i++) {
+			auto& cell = m_cells[(start + i) & mask];
+			new (&cell.storage) T(items[i]);
+			cell.sequence.store(start + i + 1, std::memory_order_release);
+		}
+
+		return claimed;
+	}
+
+	template <typename T, int size>
+	std::size_t BoundedQueue<T, size>::takeBatch(T* items, const std::size_t count) {
+		std::size_t start;
+		const auto claimed = claim(m_dequeuePosition, 1, count, start);
+
+		for (std::size_t i = 0; i < claimed; i++) {
+			auto& cell = m_cells[(start + i) & mask];
+			auto item = itemAt(cell);
+			items[i] = std::move(*item);
+			item->~T();
+			cell.sequence.store(start + i + capacity, std::memory_order_release);
+		}
+
+		return claimed;
+	}
+
+	template <typename T, int size>
+	std::size_t BoundedQueue<T, size>::count() const {
+		const auto dequeued = m_dequeuePosition.load(std::memory_order_relaxed);
+		const auto enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+
+		if (enqueued <= dequeued) {
+			return 0;
+		}
+
+		return enqueued - dequeued > capacity ? capacity : enqueued - dequeued;
+	}
+
+	template <typename T, int size>
+	bool BoundedQueue<T, size>::isEmpty() const {
+		return count() == 0;
+	}
+
+	template <typename T, int size>
+	bool BoundedQueue<T, size>::isFilled() const {
+		return count() >= capacity;
+	}
+
+	template <typename T, int size>
+	T* BoundedQueue<T, size>::itemAt(Cell& cell) {
+		return reinterpret_cast<T*>(&cell.storage);
+	}
+
+	template <typename T, int size>
+	std::size_t BoundedQueue<T, size>::claim(std::atomic<std::size_t>& position, const std::size_t lag, const std::size_t count,
+		std::size_t& start) {
+		// a cell is free for the producer at position p when its sequence is p, and ready for the consumer when it is p + 1;
+		// a run of such cells can only be taken by whoever moves the position past them, so one CAS claims the whole batch
+		auto current = position.load(std::memory_order_relaxed);
+
+		for (;;) {
+			std::size_t available = 0;
+			while (available < count
+				&& m_cells[(current + available) & mask].sequence.load(std::memory_order_acquire) == current + available + lag) {
+				available++;
+			}
+
+			if (available == 0) {
+				const auto sequence = m_cells[current & mask].sequence.load(std::memory_order_acquire);
+				if (static_cast<std::intptr_t>(sequence - (current + lag)) < 0) {
+					return 0;
+				}
+
+				current = position.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if (position.compare_exchange_weak(current, current + available, std::memory_order_relaxed)) {
+				start = current;
+				return available;
+			}
+		}
+	}
+}
+
+#endif
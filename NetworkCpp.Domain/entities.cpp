@@ -1,20 +1,50 @@
 #include "entities.h"
 
+#include "aggregation.h"
+
+namespace {
+	// buffers and an attached aggregator are copied, so a copy never reports into the original's totals
+	template<typename Storage>
+	std::shared_ptr<Storage> copyOf(const std::shared_ptr<Storage>& source) {
+		if (!source) {
+			return nullptr;
+		}
+
+		auto copy = std::allocate_shared<Storage>(storage::PoolAllocator<Storage>(), *source);
+		if (copy->aggregator) {
+			copy->aggregator = std::make_shared<aggregation::ReceiveAggregator>(*copy->aggregator);
+		}
+		return copy;
+	}
+}
+
+// endpoints keep only the identity, copying the nodes would drag their buffers into every message
 entities::Message::Message(const int size, const Node& sender, const Node& receiver)
-	: Identifiable(), m_size(size), m_sender(std::make_shared<Node>(sender))
-		, m_receiver(std::make_shared<Node>(receiver)) {
+	: Identifiable(), m_size(size), m_sender(std::make_shared<Node>(sender.id()))
+		, m_receiver(std::make_shared<Node>(receiver.id())), m_sentAt(0), m_receivedAt(0) {
+}
+
+entities::Message::Message(const boost::uuids::uuid& id, const int size, const std::shared_ptr<const Node>& sender,
+	const std::shared_ptr<const Node>& receiver)
+	: Identifiable(id), m_size(size), m_sender(sender), m_receiver(receiver), m_sentAt(0), m_receivedAt(0) {
 }
 
 entities::Message::Message(const Message& message) noexcept
 	: Identifiable(message), m_size(message.m_size), m_sender(message.m_sender)
-		, m_receiver(message.m_receiver) {
+		, m_receiver(message.m_receiver), m_sentAt(message.m_sentAt), m_receivedAt(message.m_receivedAt)
+		, m_payload(message.m_payload) {
 }
 
 const entities::Message& entities::Message::operator=(const Message& message) {
-	Identifiable::operator=(message);
-
 	if (this != &message) {
-		*this = Message(message);
+		Identifiable::operator=(message);
+
+		m_size = message.m_size;
+		m_sender = message.m_sender;
+		m_receiver = message.m_receiver;
+		m_sentAt = message.m_sentAt;
+		m_receivedAt = message.m_receivedAt;
+		m_payload = message.m_payload;
 	}
 
 	return *this;
@@ -32,6 +62,41 @@ const entities::Node& entities::Message::receiver() const {
 	return *m_receiver;
 }
 
+double entities::Message::sentAt() const {
+	return m_sentAt;
+}
+
+void entities::Message::setSentAt(const double time) {
+	m_sentAt = time;
+}
+
+double entities::Message::receivedAt() const {
+	return m_receivedAt;
+}
+
+void entities::Message::setReceivedAt(const double time) {
+	m_receivedAt = time;
+}
+
+double entities::Message::latency() const {
+	return m_receivedAt - m_sentAt;
+}
+
+const payload::Payload& entities::Message::payload() const {
+	static const payload::Payload empty;
+	return m_payload ? *m_payload : empty;
+}
+
+void entities::Message::setPayload(const payload::Payload& payload) {
+	// copies share the payload, so forwarding only bumps a reference count
+	setPayload(std::make_shared<const payload::Payload>(payload));
+}
+
+void entities::Message::setPayload(const std::shared_ptr<const payload::Payload>& payload) {
+	m_payload = payload;
+	m_size = payload ? static_cast<int>(payload->size()) : m_size;
+}
+
 entities::Observable::Observable() {
 }
 
@@ -43,12 +108,12 @@ entities::Observable::~Observable() {
 	m_observers.clear();
 }
 
-void entities::Observable::addObserver(const Observer const * observer) {
+void entities::Observable::addObserver(Observer* observer) {
 	m_observers.push_back(observer);
 }
 
-void entities::Observable::removeObserver(const Observer* observer) {
-	auto iterator = find(m_observers.cbegin(), m_observers.cend(), observer);
+void entities::Observable::removeObserver(Observer* observer) {
+	auto iterator = std::find(m_observers.cbegin(), m_observers.cend(), observer);
 	if (iterator == m_observers.cend()) {
 		return;
 	}
@@ -72,31 +137,62 @@ entities::Observer::~Observer() {
 entities::MessageContainerObserver::~MessageContainerObserver() {
 }
 
+entities::MessageContainerObservable::MessageContainerObservable()
+	: Observable() {
+}
+
+entities::MessageContainerObservable::MessageContainerObservable(const MessageContainerObservable& observable)
+	: Observable(observable) {
+}
+
+entities::MessageContainerObservable::~MessageContainerObservable() {
+}
+
 void entities::MessageContainerObservable::onAdd(const Message& added) {
-	for (MessageContainerObserver* listener : m_observers) {
-		listener->addListener(this, added);
+	for (auto observer : m_observers) {
+		static_cast<MessageContainerObserver*>(observer)->addListener(this, added);
 	}
 }
 
 void entities::MessageContainerObservable::onClear() {
-	for (MessageContainerObserver* listener : m_observers) {
-		listener->clearListener(this);
+	for (auto observer : m_observers) {
+		static_cast<MessageContainerObserver*>(observer)->clearListener(this);
 	}
 }
 
 void entities::MessageContainerObservable::onRemove(const Message& removed) {
-	for (auto listener : m_observers) {
-		auto converted = (MessageContainerObserver *)listener;
-		listener->removeListener(this, removed);
+	for (auto observer : m_observers) {
+		static_cast<MessageContainerObserver*>(observer)->removeListener(this, removed);
 	}
 }
 
+entities::Counted::Counted()
+	: m_added(0), m_removed(0), m_cleared(0) {
+}
+
+std::uint64_t entities::Counted::added() const {
+	return m_added;
+}
+
+std::uint64_t entities::Counted::removed() const {
+	return m_removed;
+}
+
+std::uint64_t entities::Counted::cleared() const {
+	return m_cleared;
+}
+
+
 entities::Node::Node()
 	: Identifiable() {
-	m_buffer = std::make_shared<MessageBuffer<>>();
-	m_receivedMessages = std::make_shared<MessageBuffer<>>();
+	m_isUnactive = false;
+	m_isCompact = false;
+}
 
+entities::Node::Node(const boost::uuids::uuid& id)
+	: Identifiable(id) {
 	m_isUnactive = false;
+	m_isCompact = false;
 }
 
 entities::Node::Node(const Node& node)
@@ -111,21 +207,76 @@ const entities::Node& entities::Node::operator=(const Node& node) {
 	Identifiable::operator=(node);
 
 	if (this != &node) {
-		this->m_buffer = std::make_shared<MessageBuffer<>>(*node.m_buffer);
-		this->m_receivedMessages = std::make_shared<MessageBuffer<>>(*node.m_receivedMessages);
-
+		this->m_storage = copyOf(node.m_storage);
+		this->m_compactStorage = copyOf(node.m_compactStorage);
 		this->m_isUnactive = node.m_isUnactive;
+		this->m_isCompact = node.m_isCompact;
 	}
 
 	return *this;
 }
 
 entities::MessageBuffer<>& entities::Node::receivedMessages() {
-	return *m_receivedMessages;
+	return storage().receivedMessages;
 }
 
 entities::MessageBuffer<>& entities::Node::buffer() {
-	return *m_buffer;
+	return storage().buffer;
+}
+
+entities::NodeBuffer& entities::Node::compactReceivedMessages() {
+	return compactStorage().receivedMessages;
+}
+
+entities::NodeBuffer& entities::Node::compactBuffer() {
+	return compactStorage().buffer;
+}
+
+int entities::Node::receivedCount() const {
+	return m_storage ? m_storage->receivedMessages.count()
+		: m_compactStorage ? m_compactStorage->receivedMessages.count() : 0;
+}
+
+int entities::Node::bufferedCount() const {
+	return m_storage ? m_storage->buffer.count() : m_compactStorage ? m_compactStorage->buffer.count() : 0;
+}
+
+void entities::Node::send(const Message& message) {
+	if (m_isCompact) {
+		compactStorage().buffer.add(message);
+	}
+	else {
+		storage().buffer.add(message);
+	}
+}
+
+void entities::Node::receive(const Message& message) {
+	const auto& aggregator = m_isCompact ? compactStorage().aggregator : storage().aggregator;
+	if (aggregator) {
+		aggregator->add(message);
+		return;
+	}
+
+	if (m_isCompact) {
+		compactStorage().receivedMessages.add(message);
+	}
+	else {
+		storage().receivedMessages.add(message);
+	}
+}
+
+const std::shared_ptr<aggregation::ReceiveAggregator>& entities::Node::aggregator() const {
+	static const std::shared_ptr<aggregation::ReceiveAggregator> none;
+	return m_storage ? m_storage->aggregator : m_compactStorage ? m_compactStorage->aggregator : none;
+}
+
+void entities::Node::setAggregator(const std::shared_ptr<aggregation::ReceiveAggregator>& aggregator) {
+	if (m_isCompact) {
+		compactStorage().aggregator = aggregator;
+	}
+	else {
+		storage().aggregator = aggregator;
+	}
 }
 
 const bool& entities::Node::isUnactive() const {
@@ -136,6 +287,52 @@ void entities::Node::setIsUnactive(const bool is_unactive) {
 	m_isUnactive = is_unactive;
 }
 
+bool entities::Node::isCompact() const {
+	return m_isCompact;
+}
+
+void entities::Node::setIsCompact(const bool is_compact) {
+	if (is_compact == m_isCompact) {
+		return;
+	}
+
+	if (bufferedCount() > 0 || receivedCount() > 0) {
+		throw std::logic_error("a node can only switch its buffers while they are empty");
+	}
+
+	// the empty buffers are dropped and come back in the new form on first use, an aggregator is kept
+	const auto aggregator = this->aggregator();
+	m_storage = nullptr;
+	m_compactStorage = nullptr;
+	m_isCompact = is_compact;
+	if (aggregator) {
+		setAggregator(aggregator);
+	}
+}
+
+entities::Node::ObservedStorage& entities::Node::storage() {
+	if (m_isCompact) {
+		throw std::logic_error("buffers of a compact node are reached through the compact accessors");
+	}
+
+	// idle nodes never pay for buffers, storage comes from the shared pool on first use
+	if (!m_storage) {
+		m_storage = std::allocate_shared<ObservedStorage>(storage::PoolAllocator<ObservedStorage>());
+	}
+	return *m_storage;
+}
+
+entities::Node::CompactStorage& entities::Node::compactStorage() {
+	if (!m_isCompact) {
+		throw std::logic_error("only a compact node has compact buffers");
+	}
+
+	if (!m_compactStorage) {
+		m_compactStorage = std::allocate_shared<CompactStorage>(storage::PoolAllocator<CompactStorage>());
+	}
+	return *m_compactStorage;
+}
+
 entities::Channel::Channel() 
 	: Observable() {
 	m_busy = false;
@@ -149,6 +346,14 @@ entities::Channel::Channel(const Channel& channel)
 entities::Channel::~Channel() {
 }
 
+bool entities::Channel::isBusy() const {
+	return m_busy;
+}
+
+void entities::Channel::setIsBusy(const bool is_busy) {
+	m_busy = is_busy;
+}
+
 entities::OneWayChannel::OneWayChannel()
 	: Channel(), MessageContainerObserver(static_cast<Observable&>(*this)), m_message(nullptr) {
 }
@@ -161,15 +366,27 @@ entities::OneWayChannel::~OneWayChannel() {
 }
 
 void entities::OneWayChannel::add(const Message& message) {
-	m_message = std::make_shared<const Message&>(message);
+	m_message = std::make_shared<const Message>(message);
 }
 
-const entities::Message& entities::OneWayChannel::get() {
-	auto message = *m_message;
+entities::Message entities::OneWayChannel::get() {
+	auto message = peek();
 	m_message = nullptr;
 	return message;
 }
 
+bool entities::OneWayChannel::isEmpty() const {
+	return m_message == nullptr;
+}
+
+const entities::Message& entities::OneWayChannel::peek() const {
+	if (isEmpty()) {
+		throw std::logic_error("channel has no message");
+	}
+
+	return *m_message;
+}
+
 void entities::OneWayChannel::addListener(void*, const Message&) {
 	m_busy = true;
 }
@@ -186,6 +403,18 @@ entities::NodesPair::NodesPair(const Node& node, const Node& node1, const Channe
 	: Identifiable(), m_first(node), m_second(node1), m_channel(channel) {
 }
 
+const entities::Node& entities::NodesPair::first() const {
+	return m_first;
+}
+
+const entities::Node& entities::NodesPair::second() const {
+	return m_second;
+}
+
+const entities::Channel& entities::NodesPair::channel() const {
+	return m_channel;
+}
+
 entities::MessageContainerObserver::MessageContainerObserver(Observable& observable) 
 	: Observer(observable) {
 }
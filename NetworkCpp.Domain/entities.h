@@ -1,10 +1,20 @@
 #ifndef _NODE_H_
 #define _NODE_H_
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 #include "interfaces.h"
+#include "payload.h"
+#include "storage.h"
+
+namespace aggregation {
+	class ReceiveAggregator;
+}
 
 namespace entities {
 	class Node;
@@ -12,6 +22,8 @@ namespace entities {
 	class Message : public interfaces::Identifiable {
 	public:
 		Message(const int size, const Node& sender, const Node& receiver);
+		Message(const boost::uuids::uuid& id, const int size, const std::shared_ptr<const Node>& sender,
+			const std::shared_ptr<const Node>& receiver);
 		Message(const Message& message) noexcept;
 
 		const Message&							operator=(const Message&);
@@ -20,10 +32,23 @@ namespace entities {
 		virtual const Node&						sender() const;
 		virtual const Node&						receiver() const;
 
+		virtual double							sentAt() const;
+		virtual void							setSentAt(const double time);
+		virtual double							receivedAt() const;
+		virtual void							setReceivedAt(const double time);
+		virtual double							latency() const;
+
+		virtual const payload::Payload&			payload() const;
+		virtual void							setPayload(const payload::Payload& payload);
+		virtual void							setPayload(const std::shared_ptr<const payload::Payload>& payload);
+
 	private:
-		const int								m_size;
-		const std::shared_ptr<const Node>		m_sender;
-		const std::shared_ptr<const Node>		m_receiver;
+		int										m_size;
+		std::shared_ptr<const Node>				m_sender;
+		std::shared_ptr<const Node>				m_receiver;
+		double									m_sentAt;
+		double									m_receivedAt;
+		std::shared_ptr<const payload::Payload>	m_payload;
 	};
 
 	class Observer;
@@ -35,11 +60,11 @@ namespace entities {
 		
 		virtual ~Observable();
 
-		void								addObserver(const Observer const *);
-		void								removeObserver(const Observer const *);
+		void								addObserver(Observer*);
+		void								removeObserver(Observer*);
 
 	protected:
-		std::vector<Observer const *>				m_observers;
+		std::vector<Observer*>						m_observers;
 	};
 
 	class Observer {
@@ -78,24 +103,58 @@ namespace entities {
 		void										onRemove(const Message&);
 	};
 
-	template<int size = INT_MAX>
-	class MessageBuffer : public Observable {
+	class Unobserved {
+	protected:
+		void										onAdd(const Message&) {}
+		void										onClear() {}
+		void										onRemove(const Message&) {}
+	};
+
+	typedef MessageContainerObservable				Observed;
+
+	class Counted {
+	public:
+		Counted();
+
+		std::uint64_t								added() const;
+		std::uint64_t								removed() const;
+		std::uint64_t								cleared() const;
+
+	protected:
+		void										onAdd(const Message&) { m_added++; }
+		void										onClear() { m_cleared++; }
+		void										onRemove(const Message&) { m_removed++; }
+
+	private:
+		std::uint64_t								m_added;
+		std::uint64_t								m_removed;
+		std::uint64_t								m_cleared;
+	};
+
+	// buffers of a message or two come straight out of the shared pool instead of the global heap
+	typedef std::vector<Message, storage::PoolAllocator<Message>>	MessageVector;
+
+	template<int size = INT_MAX, typename Notification = Observed>
+	class MessageBuffer : public Notification {
 		static_assert(size > 0, "Size should non-negative and not zero");
+
+		template<int, typename>
+		friend class MessageBuffer;
 	public:
 		MessageBuffer();
 		MessageBuffer(const MessageBuffer&);
-		template<int copySize>
-		MessageBuffer(const MessageBuffer<copySize>&);
+		template<int copySize, typename CopyNotification>
+		MessageBuffer(const MessageBuffer<copySize, CopyNotification>&);
 
 		~MessageBuffer();
 
 		bool										isFilled() const;
 
-		std::vector<Message>::iterator				begin();
-		std::vector<Message>::iterator				end();
+		MessageVector::iterator						begin();
+		MessageVector::iterator						end();
 
-		std::vector<Message>::const_iterator		cbegin() const;
-		std::vector<Message>::const_iterator		cend() const;
+		MessageVector::const_iterator				cbegin() const;
+		MessageVector::const_iterator				cend() const;
 
 		void										add(const Message&);
 		void										clear();
@@ -108,100 +167,94 @@ namespace entities {
 
 		const Message&								operator[](size_t index);
 		const MessageBuffer&						operator=(const MessageBuffer&);
-		template<int copySize>
-		const MessageBuffer&						operator=(const MessageBuffer<copySize>&);
+		template<int copySize, typename CopyNotification>
+		const MessageBuffer&						operator=(const MessageBuffer<copySize, CopyNotification>&);
 	private:
-		std::vector<Message>						m_buffer;
-
-		void										onAdd(const Message&);
-		void										onClear();
-		void										onRemove(const Message&);
+		MessageVector								m_buffer;
 	};
 
-	template <int size>
-	MessageBuffer<size>::MessageBuffer()
-		: Observable() {
+	template <int size, typename Notification>
+	MessageBuffer<size, Notification>::MessageBuffer()
+		: Notification() {
 	}
 
-	template <int size>
-	MessageBuffer<size>::MessageBuffer(const MessageBuffer<size>& buffer)
-		: Observable(buffer) {
-		*this = buffer;
+	template <int size, typename Notification>
+	MessageBuffer<size, Notification>::MessageBuffer(const MessageBuffer<size, Notification>& buffer)
+		: Notification(buffer), m_buffer(buffer.m_buffer) {
 	}
 
-	template <int size>
-	template <int copySize>
-	MessageBuffer<size>::MessageBuffer(const MessageBuffer<copySize>& buffer)
+	template <int size, typename Notification>
+	template <int copySize, typename CopyNotification>
+	MessageBuffer<size, Notification>::MessageBuffer(const MessageBuffer<copySize, CopyNotification>& buffer)
 		: MessageBuffer() {
 		*this = buffer;
 	}
 
-	template <int size>
-	MessageBuffer<size>::~MessageBuffer() {
+	template <int size, typename Notification>
+	MessageBuffer<size, Notification>::~MessageBuffer() {
 		m_buffer.clear();
-		m_observers.clear();
 	}
 
-	template <int size>
-	bool MessageBuffer<size>::isFilled() const {
+	template <int size, typename Notification>
+	bool MessageBuffer<size, Notification>::isFilled() const {
 		return m_buffer.size() >= size;
 	}
 
-	template <int size>
-	std::vector<Message>::iterator MessageBuffer<size>::begin() {
+	template <int size, typename Notification>
+	MessageVector::iterator MessageBuffer<size, Notification>::begin() {
 		return m_buffer.begin();
 	}
 
-	template <int size>
-	std::vector<Message>::iterator MessageBuffer<size>::end() {
+	template <int size, typename Notification>
+	MessageVector::iterator MessageBuffer<size, Notification>::end() {
 		return m_buffer.end();
 	}
 
-	template <int size>
-	std::vector<Message>::const_iterator MessageBuffer<size>::cbegin() const {
+	template <int size, typename Notification>
+	MessageVector::const_iterator MessageBuffer<size, Notification>::cbegin() const {
 		return m_buffer.cbegin();
 	}
 
-	template <int size>
-	std::vector<Message>::const_iterator MessageBuffer<size>::cend() const {
+	template <int size, typename Notification>
+	MessageVector::const_iterator MessageBuffer<size, Notification>::cend() const {
 		return m_buffer.cend();
 	}
 
-	template <int size>
-	void MessageBuffer<size>::add(const Message& message) {
+	template <int size, typename Notification>
+	void MessageBuffer<size, Notification>::add(const Message& message) {
 		if (isFilled()) {
 			return;
 		}
 
 		m_buffer.push_back(message);
-		onAdd(message);
+		this->onAdd(message);
 	}
 
-	template <int size>
-	void MessageBuffer<size>::clear() {
+	template <int size, typename Notification>
+	void MessageBuffer<size, Notification>::clear() {
 		m_buffer.clear();
-		onClear();
+		this->onClear();
 	}
 
-	template <int size>
-	void MessageBuffer<size>::remove(const Message& message) {
-		auto pointer = find(m_buffer.cbegin(), m_buffer.cend(), message);
+	template <int size, typename Notification>
+	void MessageBuffer<size, Notification>::remove(const Message& message) {
+		auto pointer = std::find(m_buffer.cbegin(), m_buffer.cend(), message);
 		if (pointer == m_buffer.cend()) {
 			return;
 		}
 
-		m_buffer.erase(find(m_buffer.cbegin(), m_buffer.cend(), message));
-		onRemove(message);
+		m_buffer.erase(pointer);
+		this->onRemove(message);
 	}
 
-	template <int size>
-	bool MessageBuffer<size>::contains(const Message& message) const {
+	template <int size, typename Notification>
+	bool MessageBuffer<size, Notification>::contains(const Message& message) const {
 		return std::find(m_buffer.cbegin(), m_buffer.cend(), message) != m_buffer.cend();
 	}
 
-	template <int size>
-	int MessageBuffer<size>::indexOf(const Message& message) const {
-		auto iterator = find(m_buffer.cbegin(), m_buffer.cend(), message);
+	template <int size, typename Notification>
+	int MessageBuffer<size, Notification>::indexOf(const Message& message) const {
+		auto iterator = std::find(m_buffer.cbegin(), m_buffer.cend(), message);
 		if (iterator == m_buffer.cend())
 		{
 			return -1;
@@ -209,72 +262,50 @@ namespace entities {
 		return iterator - m_buffer.cbegin();
 	}
 
-	template <int size>
-	int MessageBuffer<size>::count() const {
+	template <int size, typename Notification>
+	int MessageBuffer<size, Notification>::count() const {
 		return m_buffer.size();
 	}
 
-	template <int size>
-	const Message& MessageBuffer<size>::operator[](size_t index) {
+	template <int size, typename Notification>
+	const Message& MessageBuffer<size, Notification>::operator[](size_t index) {
 		return m_buffer[index];
 	}
 
-	template <int size>
-	const MessageBuffer<size>& MessageBuffer<size>::operator=(const MessageBuffer& buffer) {
+	template <int size, typename Notification>
+	const MessageBuffer<size, Notification>& MessageBuffer<size, Notification>::operator=(const MessageBuffer& buffer) {
 		if (this != &buffer) {
 			this->clear();
-			this->m_observers.clear();
+			Notification::operator=(buffer);
 
 			this->m_buffer.insert(this->m_buffer.cbegin(), buffer.m_buffer.cbegin(), buffer.m_buffer.cend());
-			this->m_observers.insert(this->m_observers.cbegin(), buffer.m_observers.cbegin(), buffer.m_observers.cend());
 		}
 
 		return *this;
 	}
 
-	template <int size>
-	template <int copySize>
-	const MessageBuffer<size>& MessageBuffer<size>::operator=(const MessageBuffer<copySize>& buffer) {
-		if (this != &buffer) {
-			if (size > copySize)
-			{
-				throw std::logic_error("cannot copy bigger to smaller buffer");
-			}
-
-			this->clear();
-			this->m_observers.clear();
-
-			this->m_buffer.insert(this->m_buffer.cbegin(), buffer.m_buffer.cbegin(), buffer.m_buffer.cend());
-			this->m_observers.insert(this->m_observers.cbegin(), buffer.m_clearListeners.cbegin(), buffer.m_clearListeners.cend());
+	template <int size, typename Notification>
+	template <int copySize, typename CopyNotification>
+	const MessageBuffer<size, Notification>& MessageBuffer<size, Notification>::operator=(const MessageBuffer<copySize, CopyNotification>& buffer) {
+		if (copySize > size)
+		{
+			throw std::logic_error("cannot copy bigger to smaller buffer");
 		}
 
-		return *this;
-	}
-
-	template <int size>
-	void MessageBuffer<size>::onAdd(const Message& added) {
-		for (MessageContainerObserver* listener : m_observers) {
-			listener->addListener(this, added);
-		}
-	}
+		// observers are only carried over between buffers of the same policy
+		this->clear();
+		this->m_buffer.insert(this->m_buffer.cbegin(), buffer.m_buffer.cbegin(), buffer.m_buffer.cend());
 
-	template <int size>
-	void MessageBuffer<size>::onClear() {
-		for (MessageContainerObserver* listener : m_observers) {
-			listener->clearListener(this);
-		}
+		return *this;
 	}
 
-	template <int size>
-	void MessageBuffer<size>::onRemove(const Message& removed) {
-		for (MessageContainerObserver* listener : m_observers) {
-			listener->removeListener(this, removed);
-		}
-	}
+	// buffers of a compact node, they skip the observer list and its dispatch
+	typedef MessageBuffer<INT_MAX, Unobserved>		NodeBuffer;
 
 	class Node : public interfaces::Identifiable {
 	public:
 		Node();
+		explicit Node(const boost::uuids::uuid& id);
 		Node(const Node& node);
 
 		~Node() override;
@@ -283,13 +314,39 @@ namespace entities {
 
 		virtual MessageBuffer<>& receivedMessages();
 		virtual MessageBuffer<>& buffer();
+		virtual NodeBuffer& compactReceivedMessages();
+		virtual NodeBuffer& compactBuffer();
+
+		virtual int receivedCount() const;
+		virtual int bufferedCount() const;
+
+		virtual void send(const Message& message);
+		virtual void receive(const Message& message);
+		virtual const std::shared_ptr<aggregation::ReceiveAggregator>& aggregator() const;
+		virtual void setAggregator(const std::shared_ptr<aggregation::ReceiveAggregator>& aggregator);
 
 		virtual const bool& isUnactive() const;
 		virtual void setIsUnactive(const bool is_unactive);
+		virtual bool isCompact() const;
+		virtual void setIsCompact(const bool is_compact);
 	private:
-		std::shared_ptr<MessageBuffer<>>				m_receivedMessages;
-		std::shared_ptr<MessageBuffer<>>				m_buffer;
+		template<typename Buffer>
+		struct Storage {
+			Buffer										receivedMessages;
+			Buffer										buffer;
+			std::shared_ptr<aggregation::ReceiveAggregator>	aggregator;
+		};
+
+		typedef Storage<MessageBuffer<>>				ObservedStorage;
+		typedef Storage<NodeBuffer>						CompactStorage;
+
+		std::shared_ptr<ObservedStorage>				m_storage;
+		std::shared_ptr<CompactStorage>					m_compactStorage;
 		bool											m_isUnactive;
+		bool											m_isCompact;
+
+		ObservedStorage&								storage();
+		CompactStorage&									compactStorage();
 	};
 
 	class Channel : public interfaces::Identifiable, public Observable {
@@ -299,6 +356,9 @@ namespace entities {
 
 		~Channel() override;
 
+		virtual bool							isBusy() const;
+		virtual void							setIsBusy(const bool is_busy);
+
 	protected:
 		bool											m_busy;
 	};
@@ -311,7 +371,10 @@ namespace entities {
 		~OneWayChannel() override;
 
 		void								add(const Message&);
-		const Message&						get();
+		Message								get();
+
+		bool								isEmpty() const;
+		const Message&						peek() const;
 
 	private:
 		void						addListener(void*, const Message&) override;
@@ -319,7 +382,7 @@ namespace entities {
 		void						clearListener(void*) override;
 
 	protected:
-		std::shared_ptr<const Message&>					m_message;
+		std::shared_ptr<const Message>					m_message;
 	};
 
 	class NodesPair : public interfaces::Identifiable {
@@ -327,6 +390,10 @@ namespace entities {
 
 		NodesPair(const Node& node, const Node& node1, const Channel& channel);
 
+		const Node&								first() const;
+		const Node&								second() const;
+		const Channel&							channel() const;
+
 	private:
 		const Node&								m_first;
 		const Node&								m_second;
@@ -0,0 +1,119 @@
+#include "failures.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	bool earlier(const failures::Event& lhs, const failures::Event& rhs) {
+		return lhs.time < rhs.time;
+	}
+}
+
+failures::FailureSchedule::FailureSchedule(std::vector<entities::Node>& nodes,
+	const std::shared_ptr<routing::RoutingTable>& routes)
+	: m_nodes(nodes), m_routes(routes), m_next(0) {
+	if (!routes || routes->graph().nodeCount() != nodes.size()) {
+		throw std::invalid_argument("routes should cover every node");
+	}
+}
+
+void failures::FailureSchedule::add(const Event& event) {
+	const auto position = std::upper_bound(m_events.begin() + m_next, m_events.end(), event, earlier);
+	m_events.insert(position, event);
+}
+
+void failures::FailureSchedule::failNodes(const double time, const std::vector<std::uint32_t>& nodes, const double duration) {
+	schedule(time, Target::Node, nodes, duration);
+}
+
+void failures::FailureSchedule::failLinks(const double time, const std::vector<std::uint32_t>& links, const double duration) {
+	schedule(time, Target::Link, links, duration);
+}
+
+void failures::FailureSchedule::failLinks(const double time, const entities::NodesPair& pair, const double duration) {
+	const auto first = std::find(m_nodes.begin(), m_nodes.end(), pair.first());
+	const auto second = std::find(m_nodes.begin(), m_nodes.end(), pair.second());
+	if (first == m_nodes.end() || second == m_nodes.end()) {
+		throw std::invalid_argument("pair should connect known nodes");
+	}
+
+	// a pair names a connection rather than a direction, both of its links go down and come back together
+	const auto& graph = m_routes->graph();
+	const auto source = static_cast<std::uint32_t>(first - m_nodes.begin());
+	const auto target = static_cast<std::uint32_t>(second - m_nodes.begin());
+	std::vector<std::uint32_t> links;
+	for (auto link : { graph.find(source, target), graph.find(target, source) }) {
+		if (link != topology::Graph::none) {
+			links.push_back(link);
+		}
+	}
+
+	if (links.empty()) {
+		throw std::invalid_argument("pair should be connected by a link");
+	}
+
+	schedule(time, Target::Link, links, duration);
+}
+
+std::size_t failures::FailureSchedule::apply(const double time) {
+	std::vector<std::uint32_t> batch;
+	std::size_t applied = 0;
+
+	// consecutive events of the same kind are handed to routing together, so shared subtrees are repaired once
+	while (m_next < m_events.size() && m_events[m_next].time <= time) {
+		const auto target = m_events[m_next].target;
+		const auto up = m_events[m_next].up;
+
+		batch.clear();
+		auto end = m_next;
+		while (end < m_events.size() && m_events[end].time <= time
+			&& m_events[end].target == target && m_events[end].up == up) {
+			batch.push_back(m_events[end++].index);
+		}
+
+		if (target == Target::Node) {
+			m_routes->setNodesUp(batch, up);
+			for (auto node : batch) {
+				m_nodes[node].setIsUnactive(!up);
+			}
+		}
+		else {
+			m_routes->setLinksUp(batch, up);
+		}
+
+		// a batch that throws stays pending, routing ignores the events it already applied when it is retried
+		m_next = end;
+		applied += batch.size();
+	}
+
+	if (m_next * 2 > m_events.size()) {
+		m_events.erase(m_events.begin(), m_events.begin() + m_next);
+		m_next = 0;
+	}
+
+	return applied;
+}
+
+std::size_t failures::FailureSchedule::pending() const {
+	return m_events.size() - m_next;
+}
+
+double failures::FailureSchedule::nextTime() const {
+	return m_next < m_events.size() ? m_events[m_next].time : std::numeric_limits<double>::infinity();
+}
+
+void failures::FailureSchedule::schedule(const double time, const Target target, const std::vector<std::uint32_t>& indices,
+	const double duration) {
+	if (duration <= 0) {
+		throw std::invalid_argument("failure duration should be positive");
+	}
+
+	for (auto index : indices) {
+		m_events.push_back(Event{ time, target, index, false });
+		if (duration != std::numeric_limits<double>::infinity()) {
+			m_events.push_back(Event{ time + duration, target, index, true });
+		}
+	}
+
+	std::stable_sort(m_events.begin() + m_next, m_events.end(), earlier);
+}
@@ -0,0 +1,54 @@
+#ifndef _FAILURES_H_
+#define _FAILURES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "entities.h"
+#include "routing.h"
+
+namespace failures {
+	enum class Target {
+		Node,
+		Link
+	};
+
+	struct Event {
+		double										time;
+		Target										target;
+		std::uint32_t								index;
+		bool										up;
+	};
+
+	class FailureSchedule {
+	public:
+		FailureSchedule(std::vector<entities::Node>& nodes, const std::shared_ptr<routing::RoutingTable>& routes);
+
+		void										add(const Event& event);
+		void										failNodes(double time, const std::vector<std::uint32_t>& nodes,
+														double duration = std::numeric_limits<double>::infinity());
+		void										failLinks(double time, const std::vector<std::uint32_t>& links,
+														double duration = std::numeric_limits<double>::infinity());
+		void										failLinks(double time, const entities::NodesPair& pair,
+														double duration = std::numeric_limits<double>::infinity());
+
+		std::size_t									apply(double time);
+
+		std::size_t									pending() const;
+		double										nextTime() const;
+
+	private:
+		std::vector<entities::Node>&				m_nodes;
+		std::shared_ptr<routing::RoutingTable>		m_routes;
+		std::vector<Event>							m_events;
+		std::size_t									m_next;
+
+		void										schedule(double time, Target target, const std::vector<std::uint32_t>& indices,
+														double duration);
+	};
+}
+
+#endif
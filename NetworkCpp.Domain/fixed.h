@@ -0,0 +1,421 @@
+#ifndef _FIXED_H_
+#define _FIXED_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace fixed {
+	constexpr std::uint32_t								none = 0xffffffff;
+
+	template<std::uint32_t From, std::uint32_t To>
+	struct Link {
+		static constexpr std::uint32_t					source = From;
+		static constexpr std::uint32_t					target = To;
+	};
+
+	template<std::uint32_t NodeCount>
+	struct Routes {
+		std::uint32_t									next[NodeCount][NodeCount];
+		std::uint32_t									distance[NodeCount][NodeCount];
+	};
+
+	template<std::uint32_t NodeCount, typename... Links>
+	constexpr bool isValid() {
+		constexpr std::uint32_t sources[] = { Links::source... };
+		constexpr std::uint32_t targets[] = { Links::target... };
+
+		for (std::size_t link = 0; link < sizeof...(Links); link++) {
+			if (sources[link] >= NodeCount || targets[link] >= NodeCount || sources[link] == targets[link]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// breadth-first search towards every destination, evaluated by the compiler so the table lands in read-only data
+	template<std::uint32_t NodeCount, typename... Links>
+	constexpr Routes<NodeCount> shortestPaths() {
+		constexpr std::uint32_t sources[] = { Links::source... };
+		constexpr std::uint32_t targets[] = { Links::target... };
+
+		Routes<NodeCount> routes{};
+		for (std::uint32_t destination = 0; destination < NodeCount; destination++) {
+			for (std::uint32_t node = 0; node < NodeCount; node++) {
+				routes.next[node][destination] = none;
+				routes.distance[node][destination] = none;
+			}
+			routes.distance[destination][destination] = 0;
+
+			std::uint32_t queue[NodeCount] = {};
+			std::uint32_t head = 0;
+			std::uint32_t tail = 0;
+			queue[tail++] = destination;
+
+			while (head < tail) {
+				const auto node = queue[head++];
+				for (std::uint32_t link = 0; link < sizeof...(Links); link++) {
+					const auto source = sources[link];
+					if (targets[link] != node || routes.distance[source][destination] != none) {
+						continue;
+					}
+
+					routes.distance[source][destination] = routes.distance[node][destination] + 1;
+					routes.next[source][destination] = link;
+					queue[tail++] = source;
+				}
+			}
+		}
+
+		return routes;
+	}
+
+	struct Message {
+		std::uint32_t									source;
+		std::uint32_t									destination;
+		int												size;
+		double											sentAt;
+	};
+
+	template<int size>
+	class Ring {
+		static_assert(size > 0, "Size should non-negative and not zero");
+	public:
+		Ring();
+
+		bool											isFilled() const;
+		bool											isEmpty() const;
+		int												count() const;
+
+		bool											add(const Message& message);
+		Message											take();
+
+	private:
+		std::array<Message, size>						m_items;
+		int												m_head;
+		int												m_count;
+	};
+
+	template<int size>
+	Ring<size>::Ring()
+		: m_items(), m_head(0), m_count(0) {
+	}
+
+	template<int size>
+	bool Ring<size>::isFilled() const {
+		return m_count >= size;
+	}
+
+	template<int size>
+	bool Ring<size>::isEmpty() const {
+		return m_count == 0;
+	}
+
+	template<int size>
+	int Ring<size>::count() const {
+		return m_count;
+	}
+
+	template<int size>
+	bool Ring<size>::add(const Message& message) {
+		if (isFilled()) {
+			return false;
+		}
+
+		auto tail = m_head + m_count;
+		m_items[tail >= size ? tail - size : tail] = message;
+		m_count++;
+		return true;
+	}
+
+	template<int size>
+	Message Ring<size>::take() {
+		const auto message = m_items[m_head];
+		m_head = m_head + 1 == size ? 0 : m_head + 1;
+		m_count--;
+		return message;
+	}
+
+	// a store-and-forward network fixed at compile time, behaving like forwarding::ForwardingEngine with unit link
+	// capacity and every buffer bounded by BufferSize, but with no ids, shared pointers or heap allocation
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	class Network {
+		static_assert(NodeCount > 0 && sizeof...(Links) > 0, "Network should have nodes and links");
+		static_assert(isValid<NodeCount, Links...>(), "Links should join two different existing nodes");
+	public:
+		static constexpr std::uint32_t					nodeCount = NodeCount;
+		static constexpr std::uint32_t					linkCount = sizeof...(Links);
+		static constexpr int							bufferSize = BufferSize;
+
+		explicit Network(double stepDuration = 1.0);
+
+		bool											send(std::uint32_t source, std::uint32_t destination, int size);
+		void											step();
+		std::size_t										run(std::size_t maxSteps);
+		void											reset();
+
+		bool											isIdle() const;
+		double											time() const;
+
+		std::size_t										inFlight() const;
+		std::size_t										delivered() const;
+		std::size_t										forwarded() const;
+		std::size_t										dropped() const;
+		std::size_t										unroutable() const;
+		std::size_t										received(std::uint32_t node) const;
+		double											latency() const;
+
+		static constexpr std::uint32_t					nextLink(std::uint32_t node, std::uint32_t destination);
+		static constexpr std::uint32_t					distance(std::uint32_t node, std::uint32_t destination);
+
+	private:
+		typedef std::tuple<Links...>					LinkList;
+
+		struct Wire {
+			Message										message;
+			bool										isFull;
+		};
+
+		static constexpr Routes<NodeCount>				routes = shortestPaths<NodeCount, Links...>();
+
+		double											m_stepDuration;
+		std::array<Ring<BufferSize>, NodeCount>			m_outboxes;
+		std::array<Ring<BufferSize>, sizeof...(Links)>	m_queues;
+		std::array<Wire, sizeof...(Links)>				m_wires;
+		std::array<std::size_t, NodeCount>				m_received;
+
+		double											m_time;
+		double											m_latency;
+		std::size_t										m_inFlight;
+		std::size_t										m_delivered;
+		std::size_t										m_forwarded;
+		std::size_t										m_dropped;
+		std::size_t										m_unroutable;
+
+		template<std::size_t... Index>
+		void											arrive(std::index_sequence<Index...>);
+		template<std::size_t Index>
+		void											arriveOn();
+		template<std::size_t... Index>
+		void											transmit(std::index_sequence<Index...>);
+		template<std::size_t Index>
+		void											transmitOn();
+
+		void											ingest();
+		void											route(std::uint32_t node, const Message& message);
+		void											deliver(std::uint32_t node, const Message& message);
+	};
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	constexpr Routes<NodeCount> Network<NodeCount, BufferSize, Links...>::routes;
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	Network<NodeCount, BufferSize, Links...>::Network(const double stepDuration)
+		: m_stepDuration(stepDuration) {
+		if (stepDuration <= 0) {
+			throw std::invalid_argument("step duration should be positive");
+		}
+
+		reset();
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	bool Network<NodeCount, BufferSize, Links...>::send(const std::uint32_t source, const std::uint32_t destination,
+		const int size) {
+		if (source >= NodeCount || destination >= NodeCount) {
+			throw std::out_of_range("node is not part of the network");
+		}
+
+		if (!m_outboxes[source].add(Message{ source, destination, size, m_time })) {
+			m_dropped++;
+			return false;
+		}
+
+		m_inFlight++;
+		return true;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	void Network<NodeCount, BufferSize, Links...>::step() {
+		// same phase order as the dynamic engine, so a hop takes exactly one step
+		arrive(std::index_sequence_for<Links...>());
+		ingest();
+		transmit(std::index_sequence_for<Links...>());
+
+		m_time += m_stepDuration;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::run(const std::size_t maxSteps) {
+		std::size_t steps = 0;
+		while (steps < maxSteps && !isIdle()) {
+			step();
+			steps++;
+		}
+
+		return steps;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	void Network<NodeCount, BufferSize, Links...>::reset() {
+		m_outboxes.fill(Ring<BufferSize>());
+		m_queues.fill(Ring<BufferSize>());
+		m_wires.fill(Wire{ Message{ 0, 0, 0, 0 }, false });
+		m_received.fill(0);
+
+		m_time = 0;
+		m_latency = 0;
+		m_inFlight = 0;
+		m_delivered = 0;
+		m_forwarded = 0;
+		m_dropped = 0;
+		m_unroutable = 0;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	bool Network<NodeCount, BufferSize, Links...>::isIdle() const {
+		return m_inFlight == 0;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	double Network<NodeCount, BufferSize, Links...>::time() const {
+		return m_time;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::inFlight() const {
+		return m_inFlight;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::delivered() const {
+		return m_delivered;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::forwarded() const {
+		return m_forwarded;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::dropped() const {
+		return m_dropped;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::unroutable() const {
+		return m_unroutable;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	std::size_t Network<NodeCount, BufferSize, Links...>::received(const std::uint32_t node) const {
+		return m_received.at(node);
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	double Network<NodeCount, BufferSize, Links...>::latency() const {
+		return m_latency;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	constexpr std::uint32_t Network<NodeCount, BufferSize, Links...>::nextLink(const std::uint32_t node,
+		const std::uint32_t destination) {
+		return routes.next[node][destination];
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	constexpr std::uint32_t Network<NodeCount, BufferSize, Links...>::distance(const std::uint32_t node,
+		const std::uint32_t destination) {
+		return routes.distance[node][destination];
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	template<std::size_t... Index>
+	void Network<NodeCount, BufferSize, Links...>::arrive(std::index_sequence<Index...>) {
+		// expands to one straight-line block per link, each with its endpoint folded in as a constant
+		using expand = int[];
+		(void)expand{ 0, (arriveOn<Index>(), 0)... };
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	template<std::size_t Index>
+	void Network<NodeCount, BufferSize, Links...>::arriveOn() {
+		auto& wire = m_wires[Index];
+		if (!wire.isFull) {
+			return;
+		}
+
+		wire.isFull = false;
+		const auto node = std::tuple_element<Index, LinkList>::type::target;
+		if (node == wire.message.destination) {
+			deliver(node, wire.message);
+		}
+		else {
+			route(node, wire.message);
+		}
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	template<std::size_t... Index>
+	void Network<NodeCount, BufferSize, Links...>::transmit(std::index_sequence<Index...>) {
+		using expand = int[];
+		(void)expand{ 0, (transmitOn<Index>(), 0)... };
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	template<std::size_t Index>
+	void Network<NodeCount, BufferSize, Links...>::transmitOn() {
+		auto& queue = m_queues[Index];
+		if (queue.isEmpty()) {
+			return;
+		}
+
+		m_wires[Index] = Wire{ queue.take(), true };
+		m_forwarded++;
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	void Network<NodeCount, BufferSize, Links...>::ingest() {
+		for (std::uint32_t node = 0; node < NodeCount; node++) {
+			auto& outbox = m_outboxes[node];
+			while (!outbox.isEmpty()) {
+				const auto message = outbox.take();
+				if (node == message.destination) {
+					deliver(node, message);
+				}
+				else {
+					route(node, message);
+				}
+			}
+		}
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	void Network<NodeCount, BufferSize, Links...>::route(const std::uint32_t node, const Message& message) {
+		const auto link = routes.next[node][message.destination];
+		if (link == none) {
+			m_unroutable++;
+			m_inFlight--;
+			return;
+		}
+
+		if (!m_queues[link].add(message)) {
+			m_dropped++;
+			m_inFlight--;
+		}
+	}
+
+	template<std::uint32_t NodeCount, int BufferSize, typename... Links>
+	void Network<NodeCount, BufferSize, Links...>::deliver(const std::uint32_t node, const Message& message) {
+		m_received[node]++;
+		m_latency += m_time - message.sentAt;
+		m_delivered++;
+		m_inFlight--;
+	}
+}
+
+#endif
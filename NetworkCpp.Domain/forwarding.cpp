@@ -0,0 +1,414 @@
+#include "forwarding.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+forwarding::ForwardingEngine::ForwardingEngine(std::vector<entities::Node>& nodes,
+	const std::shared_ptr<routing::RoutingTable>& routes, const double stepDuration, const std::size_t linkCapacity,
+	const std::size_t queueCapacity)
+	: m_nodes(nodes), m_routes(routes), m_stepDuration(stepDuration), m_linkCapacity(linkCapacity),
+	m_queueCapacity(queueCapacity), m_time(0), m_version(routes ? routes->version() : 0), m_inFlight(0), m_delivered(0),
+	m_forwarded(0), m_dropped(0), m_unroutable(0), m_rerouted(0) {
+	if (!routes || routes->graph().nodeCount() != nodes.size()) {
+		throw std::invalid_argument("routes should cover every node");
+	}
+
+	if (stepDuration <= 0 || linkCapacity == 0 || queueCapacity == 0) {
+		throw std::invalid_argument("step duration and capacities should be positive");
+	}
+
+	m_indices.reserve(nodes.size());
+	for (std::uint32_t i = 0; i < nodes.size(); i++) {
+		m_indices.emplace(nodes[i].id(), i);
+	}
+
+	m_queues.resize(routes->graph().linkCount(), Queue{ std::vector<Packet>(), 0 });
+	m_unactive.resize(nodes.size(), 0);
+	m_traced.resize(nodes.size(), 0);
+}
+
+void forwarding::ForwardingEngine::step() {
+	follow();
+
+	// packets sent over a link in the previous step land first, so every hop takes exactly one step
+	arrive();
+	ingest();
+	if (m_version != m_routes->version()) {
+		reroute();
+	}
+	transmit();
+
+	m_time += m_stepDuration;
+}
+
+std::size_t forwarding::ForwardingEngine::run(const std::size_t maxSteps) {
+	std::size_t steps = 0;
+	while (steps < maxSteps && !isIdle()) {
+		step();
+		steps++;
+	}
+
+	return steps;
+}
+
+void forwarding::ForwardingEngine::setTracer(const std::shared_ptr<tracing::TraceWriter>& tracer) {
+	m_tracer = tracer;
+	std::fill(m_traced.begin(), m_traced.end(), 0);
+}
+
+void forwarding::ForwardingEngine::setRecorder(const std::shared_ptr<metrics::LatencyRecorder>& recorder) {
+	m_recorder = recorder;
+}
+
+forwarding::State forwarding::ForwardingEngine::state() const {
+	auto state = State{ m_time, { m_delivered, m_forwarded, m_dropped, m_unroutable, m_rerouted },
+		std::vector<entities::Message>(), std::vector<std::uint32_t>(), std::vector<std::uint32_t>(), std::vector<double>(),
+		m_arrivals.size() };
+	state.messages.reserve(m_inFlight);
+
+	for (const auto& hop : m_arrivals) {
+		state.messages.push_back(m_messages[hop.packet.message]);
+		state.destinations.push_back(hop.packet.destination);
+		state.places.push_back(hop.node);
+		state.queuedAt.push_back(hop.packet.queuedAt);
+	}
+
+	for (auto link : m_activeLinks) {
+		const auto& queue = m_queues[link];
+		for (auto packet = queue.packets.begin() + queue.head; packet != queue.packets.end(); ++packet) {
+			state.messages.push_back(m_messages[packet->message]);
+			state.destinations.push_back(packet->destination);
+			state.places.push_back(link);
+			state.queuedAt.push_back(packet->queuedAt);
+		}
+	}
+
+	return state;
+}
+
+void forwarding::ForwardingEngine::setState(const State& state) {
+	if (m_inFlight > 0) {
+		throw std::logic_error("state can only be restored into an idle engine");
+	}
+
+	const auto count = state.messages.size();
+	if (state.counters.size() != 5 || state.destinations.size() != count || state.places.size() != count
+		|| state.queuedAt.size() != count || state.landing > count) {
+		throw std::invalid_argument("engine state is incomplete");
+	}
+
+	const auto& graph = m_routes->graph();
+	for (std::size_t i = 0; i < count; i++) {
+		if (state.destinations[i] >= graph.nodeCount()
+			|| state.places[i] >= (i < state.landing ? graph.nodeCount() : graph.linkCount())) {
+			throw std::invalid_argument("engine state does not match the topology");
+		}
+	}
+
+	m_messages = state.messages;
+	m_freeMessages.clear();
+	m_arrivals.clear();
+
+	// queues are refilled in send order, so the active links come back in the order they were served
+	for (std::uint32_t i = 0; i < count; i++) {
+		const auto packet = Packet{ i, state.destinations[i], state.queuedAt[i] };
+		if (i < state.landing) {
+			m_arrivals.push_back(Hop{ state.places[i], packet });
+			continue;
+		}
+
+		auto& queue = m_queues[state.places[i]];
+		if (queue.packets.size() == queue.head) {
+			m_activeLinks.push_back(state.places[i]);
+		}
+		queue.packets.push_back(packet);
+	}
+
+	m_time = state.time;
+	m_inFlight = count;
+	m_delivered = static_cast<std::size_t>(state.counters[0]);
+	m_forwarded = static_cast<std::size_t>(state.counters[1]);
+	m_dropped = static_cast<std::size_t>(state.counters[2]);
+	m_unroutable = static_cast<std::size_t>(state.counters[3]);
+	m_rerouted = static_cast<std::size_t>(state.counters[4]);
+	m_version = m_routes->version();
+}
+
+bool forwarding::ForwardingEngine::isIdle() const {
+	if (m_inFlight > 0) {
+		return false;
+	}
+
+	// messages waiting in a live node's buffer are picked up on the next step, a failed node holds them until it recovers
+	for (std::uint32_t node = 0; node < m_nodes.size(); node++) {
+		if (m_nodes[node].bufferedCount() > 0 && m_routes->isNodeUp(node)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+double forwarding::ForwardingEngine::time() const {
+	return m_time;
+}
+
+std::size_t forwarding::ForwardingEngine::inFlight() const {
+	return m_inFlight;
+}
+
+std::size_t forwarding::ForwardingEngine::delivered() const {
+	return m_delivered;
+}
+
+std::size_t forwarding::ForwardingEngine::forwarded() const {
+	return m_forwarded;
+}
+
+std::size_t forwarding::ForwardingEngine::dropped() const {
+	return m_dropped;
+}
+
+std::size_t forwarding::ForwardingEngine::unroutable() const {
+	return m_unroutable;
+}
+
+std::size_t forwarding::ForwardingEngine::rerouted() const {
+	return m_rerouted;
+}
+
+std::size_t forwarding::ForwardingEngine::queued(const std::uint32_t link) const {
+	const auto& queue = m_queues.at(link);
+	return queue.packets.size() - queue.head;
+}
+
+void forwarding::ForwardingEngine::follow() {
+	std::vector<std::uint32_t> failed;
+	std::vector<std::uint32_t> recovered;
+
+	// only flips of the flag are passed on, so nodes failed directly through routing stay down
+	for (std::uint32_t node = 0; node < m_nodes.size(); node++) {
+		const char unactive = m_nodes[node].isUnactive() ? 1 : 0;
+		if (unactive != m_unactive[node]) {
+			m_unactive[node] = unactive;
+			(unactive ? failed : recovered).push_back(node);
+		}
+	}
+
+	if (!failed.empty()) {
+		m_routes->setNodesUp(failed, false);
+	}
+	if (!recovered.empty()) {
+		m_routes->setNodesUp(recovered, true);
+	}
+}
+
+void forwarding::ForwardingEngine::ingest() {
+	for (std::uint32_t node = 0; node < m_nodes.size(); node++) {
+		// only changed depths are traced, so idle nodes never open a track
+		const auto buffered = m_nodes[node].bufferedCount();
+		if (m_tracer && buffered != m_traced[node]) {
+			m_tracer->counter(tracing::Kind::Node, node, m_time, buffered);
+			m_traced[node] = buffered;
+		}
+
+		// a failed node keeps its outbound messages until it recovers
+		if (buffered == 0 || !m_routes->isNodeUp(node)) {
+			continue;
+		}
+
+		if (m_nodes[node].isCompact()) {
+			ingest(node, m_nodes[node].compactBuffer());
+		}
+		else {
+			ingest(node, m_nodes[node].buffer());
+		}
+	}
+}
+
+template<typename Buffer>
+void forwarding::ForwardingEngine::ingest(const std::uint32_t node, Buffer& buffer) {
+	for (auto message = buffer.cbegin(); message != buffer.cend(); ++message) {
+		const auto destination = m_indices.find(message->receiver().id());
+		if (destination == m_indices.end()) {
+			m_unroutable++;
+			continue;
+		}
+
+		std::uint32_t slot;
+		if (m_freeMessages.empty()) {
+			slot = static_cast<std::uint32_t>(m_messages.size());
+			m_messages.push_back(*message);
+		}
+		else {
+			slot = m_freeMessages.back();
+			m_freeMessages.pop_back();
+			m_messages[slot] = *message;
+		}
+
+		m_inFlight++;
+		const auto packet = Packet{ slot, destination->second, m_time };
+		if (node == packet.destination) {
+			deliver(node, packet);
+		}
+		else {
+			route(node, packet);
+		}
+	}
+
+	// the whole buffer is handed over at once
+	buffer.clear();
+}
+
+void forwarding::ForwardingEngine::arrive() {
+	for (const auto& hop : m_arrivals) {
+		if (!m_routes->isNodeUp(hop.node)) {
+			m_dropped++;
+			release(hop.packet.message);
+			if (m_tracer) {
+				m_tracer->drop(tracing::Kind::Node, hop.node, m_time);
+			}
+		}
+		else if (hop.node == hop.packet.destination) {
+			deliver(hop.node, hop.packet);
+		}
+		else {
+			route(hop.node, hop.packet);
+		}
+	}
+
+	m_arrivals.clear();
+}
+
+void forwarding::ForwardingEngine::transmit() {
+	const auto& graph = m_routes->graph();
+	std::size_t active = 0;
+
+	// links are served in index order, as the sharded simulation does, so a node sees its landings in the same order
+	std::sort(m_activeLinks.begin(), m_activeLinks.end());
+	for (auto link : m_activeLinks) {
+		auto& queue = m_queues[link];
+		const auto count = std::min(m_linkCapacity, queue.packets.size() - queue.head);
+		const auto target = graph.link(link).target;
+
+		// the depth before sending is the peak of the step, the link stays busy until the step ends
+		if (m_tracer) {
+			m_tracer->counter(tracing::Kind::Link, link, m_time, queue.packets.size() - queue.head);
+			m_tracer->busy(tracing::Kind::Link, link, m_time, true);
+		}
+
+		// a hop lasts from joining the queue until landing at the end of this step
+		for (std::size_t i = 0; i < count; i++) {
+			const auto& packet = queue.packets[queue.head++];
+			if (m_recorder) {
+				m_recorder->recordHop(link, m_time + m_stepDuration - packet.queuedAt);
+			}
+			m_arrivals.push_back(Hop{ target, packet });
+		}
+		m_forwarded += count;
+
+		if (queue.head == queue.packets.size()) {
+			queue.packets.clear();
+			queue.head = 0;
+			if (m_tracer) {
+				m_tracer->counter(tracing::Kind::Link, link, m_time + m_stepDuration, 0);
+				m_tracer->busy(tracing::Kind::Link, link, m_time + m_stepDuration, false);
+			}
+			continue;
+		}
+
+		// compact lazily so a long backlog is not shifted on every step
+		if (queue.head * 2 > queue.packets.size()) {
+			queue.packets.erase(queue.packets.begin(), queue.packets.begin() + queue.head);
+			queue.head = 0;
+		}
+		m_activeLinks[active++] = link;
+	}
+
+	m_activeLinks.resize(active);
+}
+
+void forwarding::ForwardingEngine::reroute() {
+	const auto& graph = m_routes->graph();
+	std::vector<Hop> stranded;
+	std::size_t active = 0;
+
+	for (auto link : m_activeLinks) {
+		if (m_routes->isUsable(link)) {
+			m_activeLinks[active++] = link;
+			continue;
+		}
+
+		auto& queue = m_queues[link];
+		const auto source = graph.link(link).source;
+		for (auto packet = queue.packets.begin() + queue.head; packet != queue.packets.end(); ++packet) {
+			stranded.push_back(Hop{ source, *packet });
+		}
+		queue.packets.clear();
+		queue.head = 0;
+		if (m_tracer) {
+			m_tracer->counter(tracing::Kind::Link, link, m_time, 0);
+			m_tracer->busy(tracing::Kind::Link, link, m_time, false);
+		}
+	}
+	m_activeLinks.resize(active);
+
+	// queues behind a failed link go back through routing at the link source, packets on a failed node are lost
+	for (const auto& hop : stranded) {
+		if (!m_routes->isNodeUp(hop.node)) {
+			m_dropped++;
+			release(hop.packet.message);
+			if (m_tracer) {
+				m_tracer->drop(tracing::Kind::Node, hop.node, m_time);
+			}
+			continue;
+		}
+
+		m_rerouted++;
+		route(hop.node, hop.packet);
+	}
+
+	m_version = m_routes->version();
+}
+
+void forwarding::ForwardingEngine::route(const std::uint32_t node, const Packet& packet) {
+	const auto link = m_routes->nextLink(node, packet.destination);
+	if (link == topology::Graph::none) {
+		m_unroutable++;
+		release(packet.message);
+		return;
+	}
+
+	auto& queue = m_queues[link];
+	const auto length = queue.packets.size() - queue.head;
+	if (length >= m_queueCapacity) {
+		m_dropped++;
+		release(packet.message);
+		if (m_tracer) {
+			m_tracer->drop(tracing::Kind::Link, link, m_time);
+		}
+		return;
+	}
+
+	if (length == 0) {
+		m_activeLinks.push_back(link);
+	}
+	queue.packets.push_back(Packet{ packet.message, packet.destination, m_time });
+}
+
+void forwarding::ForwardingEngine::deliver(const std::uint32_t node, const Packet& packet) {
+	auto& message = m_messages[packet.message];
+	message.setReceivedAt(m_time);
+	if (m_recorder) {
+		m_recorder->record(message);
+	}
+	m_nodes[node].receive(message);
+
+	m_delivered++;
+	release(packet.message);
+}
+
+void forwarding::ForwardingEngine::release(const std::uint32_t message) {
+	m_freeMessages.push_back(message);
+	m_inFlight--;
+}
@@ -0,0 +1,114 @@
+#ifndef _FORWARDING_H_
+#define _FORWARDING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "entities.h"
+#include "metrics.h"
+#include "routing.h"
+#include "tracing.h"
+
+namespace forwarding {
+	struct Packet {
+		std::uint32_t								message;
+		std::uint32_t								destination;
+		double										queuedAt;
+	};
+
+	// what a stopped run needs to resume, packets landing next step come first, then each active link's queue in
+	// send order, places are the landing node or the queued link
+	struct State {
+		double										time;
+		std::vector<std::uint64_t>					counters;
+		std::vector<entities::Message>				messages;
+		std::vector<std::uint32_t>					destinations;
+		std::vector<std::uint32_t>					places;
+		std::vector<double>							queuedAt;
+		std::size_t									landing;
+	};
+
+	class ForwardingEngine {
+	public:
+		ForwardingEngine(std::vector<entities::Node>& nodes, const std::shared_ptr<routing::RoutingTable>& routes,
+			double stepDuration = 1.0, std::size_t linkCapacity = 1,
+			std::size_t queueCapacity = std::numeric_limits<std::size_t>::max());
+
+		void										step();
+		std::size_t									run(std::size_t maxSteps);
+
+		void										setTracer(const std::shared_ptr<tracing::TraceWriter>& tracer);
+		void										setRecorder(const std::shared_ptr<metrics::LatencyRecorder>& recorder);
+
+		State										state() const;
+		void										setState(const State& state);
+
+		bool										isIdle() const;
+		double										time() const;
+
+		std::size_t									inFlight() const;
+		std::size_t									delivered() const;
+		std::size_t									forwarded() const;
+		std::size_t									dropped() const;
+		std::size_t									unroutable() const;
+		std::size_t									rerouted() const;
+		std::size_t									queued(std::uint32_t link) const;
+
+	private:
+		struct Queue {
+			std::vector<Packet>						packets;
+			std::size_t								head;
+		};
+
+		struct Hop {
+			std::uint32_t							node;
+			Packet									packet;
+		};
+
+		std::vector<entities::Node>&				m_nodes;
+		std::shared_ptr<routing::RoutingTable>		m_routes;
+		std::shared_ptr<tracing::TraceWriter>		m_tracer;
+		std::shared_ptr<metrics::LatencyRecorder>	m_recorder;
+		const double								m_stepDuration;
+		const std::size_t							m_linkCapacity;
+		const std::size_t							m_queueCapacity;
+
+		std::unordered_map<boost::uuids::uuid, std::uint32_t, boost::hash<boost::uuids::uuid>>	m_indices;
+		std::vector<entities::Message>				m_messages;
+		std::vector<std::uint32_t>					m_freeMessages;
+		std::vector<Queue>							m_queues;
+		std::vector<std::uint32_t>					m_activeLinks;
+		std::vector<Hop>							m_arrivals;
+		std::vector<char>							m_unactive;
+		std::vector<int>							m_traced;
+
+		double										m_time;
+		std::uint64_t								m_version;
+		std::size_t									m_inFlight;
+		std::size_t									m_delivered;
+		std::size_t									m_forwarded;
+		std::size_t									m_dropped;
+		std::size_t									m_unroutable;
+		std::size_t									m_rerouted;
+
+		void										follow();
+		void										ingest();
+		template<typename Buffer>
+		void										ingest(std::uint32_t node, Buffer& buffer);
+		void										arrive();
+		void										transmit();
+		void										reroute();
+
+		void										route(std::uint32_t node, const Packet& packet);
+		void										deliver(std::uint32_t node, const Packet& packet);
+		void										release(std::uint32_t message);
+	};
+}
+
+#endif
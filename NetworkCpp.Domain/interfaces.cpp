@@ -6,10 +6,19 @@ interfaces::Identifiable::Identifiable()
 	: m_id(boost::uuids::random_generator()()) {
 }
 
+interfaces::Identifiable::Identifiable(const boost::uuids::uuid& id)
+	: m_id(id) {
+}
+
 interfaces::Identifiable::Identifiable(const Identifiable& obj) noexcept
 	: m_id(obj.m_id) {
 }
 
+interfaces::Identifiable& interfaces::Identifiable::operator=(const Identifiable& obj) noexcept {
+	m_id = obj.m_id;
+	return *this;
+}
+
 boost::uuids::uuid interfaces::Identifiable::id() const {
 	return m_id;
 }
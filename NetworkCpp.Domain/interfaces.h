@@ -13,8 +13,11 @@ namespace interfaces {
 	class Identifiable {
 	public:
 		Identifiable();
+		explicit Identifiable(const boost::uuids::uuid& id);
 		Identifiable(const Identifiable &) noexcept;
 
+		Identifiable& operator=(const Identifiable&) noexcept;
+
 		virtual ~Identifiable() = default;
 
 		friend bool operator==(const Identifiable& lhs, const Identifiable& rhs);
@@ -0,0 +1,213 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "bits.h"
+
+metrics::LatencyHistogram::LatencyHistogram(const int precision)
+	: m_precision(precision), m_count(0), m_min(std::numeric_limits<std::uint64_t>::max()), m_max(0), m_sum(0) {
+	if (precision < 1 || precision > 16) {
+		throw std::invalid_argument("histogram precision should be within [1, 16] bits");
+	}
+}
+
+void metrics::LatencyHistogram::record(const std::uint64_t value) {
+	record(value, 1);
+}
+
+void metrics::LatencyHistogram::record(const std::uint64_t value, const std::uint64_t count) {
+	const auto index = indexOf(value);
+	if (index >= m_counts.size()) {
+		m_counts.resize(index + 1);
+	}
+
+	m_counts[index] += count;
+	m_count += count;
+	m_sum += static_cast<double>(value) * count;
+	m_min = std::min(m_min, value);
+	m_max = std::max(m_max, value);
+}
+
+void metrics::LatencyHistogram::merge(const LatencyHistogram& histogram) {
+	if (histogram.m_precision != m_precision) {
+		throw std::logic_error("cannot merge histograms of different precision");
+	}
+
+	if (histogram.m_counts.size() > m_counts.size()) {
+		m_counts.resize(histogram.m_counts.size());
+	}
+
+	for (std::size_t i = 0; i < histogram.m_counts.size(); i++) {
+		m_counts[i] += histogram.m_counts[i];
+	}
+
+	m_count += histogram.m_count;
+	m_sum += histogram.m_sum;
+	m_min = std::min(m_min, histogram.m_min);
+	m_max = std::max(m_max, histogram.m_max);
+}
+
+void metrics::LatencyHistogram::clear() {
+	m_counts.clear();
+	m_count = 0;
+	m_sum = 0;
+	m_min = std::numeric_limits<std::uint64_t>::max();
+	m_max = 0;
+}
+
+int metrics::LatencyHistogram::precision() const {
+	return m_precision;
+}
+
+std::uint64_t metrics::LatencyHistogram::count() const {
+	return m_count;
+}
+
+std::uint64_t metrics::LatencyHistogram::min() const {
+	return m_count == 0 ? 0 : m_min;
+}
+
+std::uint64_t metrics::LatencyHistogram::max() const {
+	return m_max;
+}
+
+double metrics::LatencyHistogram::mean() const {
+	return m_count == 0 ? 0 : m_sum / m_count;
+}
+
+std::uint64_t metrics::LatencyHistogram::percentile(const double percent) const {
+	if (m_count == 0) {
+		return 0;
+	}
+
+	const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percent / 100 * m_count)));
+	std::uint64_t seen = 0;
+
+	for (std::size_t i = 0; i < m_counts.size(); i++) {
+		seen += m_counts[i];
+		if (seen >= rank) {
+			return std::min(highestOf(i), m_max);
+		}
+	}
+
+	return m_max;
+}
+
+std::size_t metrics::LatencyHistogram::bucketCount() const {
+	return m_counts.size();
+}
+
+std::size_t metrics::LatencyHistogram::indexOf(const std::uint64_t value) const {
+	// values below 2^precision are counted exactly, every later power of two is split into 2^(precision - 1) buckets
+	const std::uint64_t linear = 1ULL << m_precision;
+	if (value < linear) {
+		return static_cast<std::size_t>(value);
+	}
+
+	const auto exponent = bits::highest(value) - m_precision + 1;
+	return static_cast<std::size_t>((std::uint64_t(exponent) << (m_precision - 1)) + (value >> exponent));
+}
+
+std::uint64_t metrics::LatencyHistogram::highestOf(const std::size_t index) const {
+	const std::size_t linear = std::size_t(1) << m_precision;
+	if (index < linear) {
+		return index;
+	}
+
+	const auto exponent = static_cast<int>((index >> (m_precision - 1)) - 1);
+	const std::uint64_t bucket = index - (std::size_t(exponent) << (m_precision - 1));
+	return ((bucket + 1) << exponent) - 1;
+}
+
+metrics::LatencyRecorder::LatencyRecorder(const double resolution, const int precision, const bool perNode, const bool perPair)
+	: m_resolution(resolution), m_precision(precision), m_perNode(perNode), m_perPair(perPair), m_global(precision) {
+	if (resolution <= 0) {
+		throw std::invalid_argument("latency resolution should be positive");
+	}
+}
+
+void metrics::LatencyRecorder::record(const entities::Message& message) {
+	record(message.sender().id(), message.receiver().id(), message.latency());
+}
+
+void metrics::LatencyRecorder::record(const boost::uuids::uuid& sender, const boost::uuids::uuid& receiver, const double latency) {
+	const auto value = valueOf(latency);
+
+	m_global.record(value);
+
+	if (m_perNode) {
+		m_nodes.emplace(receiver, LatencyHistogram(m_precision)).first->second.record(value);
+	}
+
+	if (m_perPair) {
+		m_pairs.emplace(Pair(sender, receiver), LatencyHistogram(m_precision)).first->second.record(value);
+	}
+}
+
+void metrics::LatencyRecorder::recordHop(const std::uint32_t link, const double latency) {
+	// links are dense graph indices, so their histograms live in a vector grown to the highest link seen
+	if (link >= m_links.size()) {
+		m_links.resize(link + 1, LatencyHistogram(m_precision));
+	}
+
+	m_links[link].record(valueOf(latency));
+}
+
+void metrics::LatencyRecorder::merge(const LatencyRecorder& recorder) {
+	if (recorder.m_resolution != m_resolution) {
+		throw std::logic_error("cannot merge recorders of different resolution");
+	}
+
+	m_global.merge(recorder.m_global);
+
+	for (const auto& node : recorder.m_nodes) {
+		m_nodes.emplace(node.first, LatencyHistogram(m_precision)).first->second.merge(node.second);
+	}
+
+	for (const auto& pair : recorder.m_pairs) {
+		m_pairs.emplace(pair.first, LatencyHistogram(m_precision)).first->second.merge(pair.second);
+	}
+
+	if (recorder.m_links.size() > m_links.size()) {
+		m_links.resize(recorder.m_links.size(), LatencyHistogram(m_precision));
+	}
+	for (std::size_t link = 0; link < recorder.m_links.size(); link++) {
+		m_links[link].merge(recorder.m_links[link]);
+	}
+}
+
+void metrics::LatencyRecorder::clear() {
+	m_global.clear();
+	m_nodes.clear();
+	m_pairs.clear();
+	m_links.clear();
+}
+
+double metrics::LatencyRecorder::resolution() const {
+	return m_resolution;
+}
+
+const metrics::LatencyHistogram& metrics::LatencyRecorder::global() const {
+	return m_global;
+}
+
+const metrics::LatencyHistogram* metrics::LatencyRecorder::node(const boost::uuids::uuid& receiver) const {
+	auto iterator = m_nodes.find(receiver);
+	return iterator == m_nodes.end() ? nullptr : &iterator->second;
+}
+
+const metrics::LatencyHistogram* metrics::LatencyRecorder::pair(const boost::uuids::uuid& sender, const boost::uuids::uuid& receiver) const {
+	auto iterator = m_pairs.find(Pair(sender, receiver));
+	return iterator == m_pairs.end() ? nullptr : &iterator->second;
+}
+
+const metrics::LatencyHistogram* metrics::LatencyRecorder::link(const std::uint32_t link) const {
+	return link < m_links.size() && m_links[link].count() > 0 ? &m_links[link] : nullptr;
+}
+
+std::uint64_t metrics::LatencyRecorder::valueOf(const double latency) const {
+	return latency > 0 ? static_cast<std::uint64_t>(latency / m_resolution + 0.5) : 0;
+}
@@ -0,0 +1,77 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "entities.h"
+
+namespace metrics {
+	class LatencyHistogram {
+	public:
+		explicit LatencyHistogram(int precision = 7);
+
+		void										record(std::uint64_t value);
+		void										record(std::uint64_t value, std::uint64_t count);
+		void										merge(const LatencyHistogram& histogram);
+		void										clear();
+
+		int											precision() const;
+		std::uint64_t								count() const;
+		std::uint64_t								min() const;
+		std::uint64_t								max() const;
+		double										mean() const;
+		std::uint64_t								percentile(double percent) const;
+		std::size_t									bucketCount() const;
+
+	private:
+		int											m_precision;
+		std::vector<std::uint64_t>					m_counts;
+		std::uint64_t								m_count;
+		std::uint64_t								m_min;
+		std::uint64_t								m_max;
+		double										m_sum;
+
+		std::size_t									indexOf(std::uint64_t value) const;
+		std::uint64_t								highestOf(std::size_t index) const;
+	};
+
+	class LatencyRecorder {
+	public:
+		typedef std::pair<boost::uuids::uuid, boost::uuids::uuid>	Pair;
+
+		explicit LatencyRecorder(double resolution = 1e-9, int precision = 7, bool perNode = true, bool perPair = true);
+
+		void										record(const entities::Message& message);
+		void										record(const boost::uuids::uuid& sender, const boost::uuids::uuid& receiver, double latency);
+		void										recordHop(std::uint32_t link, double latency);
+		void										merge(const LatencyRecorder& recorder);
+		void										clear();
+
+		double										resolution() const;
+		const LatencyHistogram&						global() const;
+		const LatencyHistogram*						node(const boost::uuids::uuid& receiver) const;
+		const LatencyHistogram*						pair(const boost::uuids::uuid& sender, const boost::uuids::uuid& receiver) const;
+		const LatencyHistogram*						link(std::uint32_t link) const;
+
+	private:
+		const double								m_resolution;
+		const int									m_precision;
+		const bool									m_perNode;
+		const bool									m_perPair;
+
+		LatencyHistogram							m_global;
+		std::unordered_map<boost::uuids::uuid, LatencyHistogram, boost::hash<boost::uuids::uuid>>	m_nodes;
+		std::unordered_map<Pair, LatencyHistogram, boost::hash<Pair>>	m_pairs;
+		std::vector<LatencyHistogram>				m_links;
+
+		std::uint64_t								valueOf(double latency) const;
+	};
+}
+
+#endif
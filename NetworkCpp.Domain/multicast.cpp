@@ -0,0 +1,194 @@
+#include "multicast.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/uuid/uuid_generators.hpp>
+
+multicast::ReceiverSet::ReceiverSet()
+	: m_universe(0), m_count(0) {
+}
+
+multicast::ReceiverSet::ReceiverSet(std::vector<std::uint32_t> receivers, const std::uint32_t universe)
+	: m_universe(universe), m_count(0) {
+	std::sort(receivers.begin(), receivers.end());
+	receivers.erase(std::unique(receivers.begin(), receivers.end()), receivers.end());
+
+	if (!receivers.empty() && receivers.back() >= universe) {
+		throw std::invalid_argument("receiver index should be less than universe");
+	}
+
+	m_count = static_cast<std::uint32_t>(receivers.size());
+
+	// a bitmap costs universe / 8 bytes and an index list 4 bytes per receiver, keep the smaller one
+	if (static_cast<std::uint64_t>(m_count) * 32 > universe) {
+		m_bits.resize((universe + wordBits - 1) / wordBits);
+		for (auto receiver : receivers) {
+			m_bits[receiver / wordBits] |= std::uint64_t(1) << (receiver % wordBits);
+		}
+	}
+	else {
+		m_indices = std::move(receivers);
+	}
+}
+
+multicast::ReceiverSet multicast::ReceiverSet::all(const std::uint32_t universe, const std::uint32_t except) {
+	std::vector<std::uint32_t> receivers;
+	receivers.reserve(universe);
+	for (std::uint32_t i = 0; i < universe; i++) {
+		if (i != except) {
+			receivers.push_back(i);
+		}
+	}
+
+	return ReceiverSet(std::move(receivers), universe);
+}
+
+std::uint32_t multicast::ReceiverSet::universe() const {
+	return m_universe;
+}
+
+std::uint32_t multicast::ReceiverSet::count() const {
+	return m_count;
+}
+
+bool multicast::ReceiverSet::isDense() const {
+	return !m_bits.empty();
+}
+
+bool multicast::ReceiverSet::contains(const std::uint32_t receiver) const {
+	return slotOf(receiver) < slots();
+}
+
+std::uint32_t multicast::ReceiverSet::slotOf(const std::uint32_t receiver) const {
+	if (isDense()) {
+		if (receiver >= m_universe || !(m_bits[receiver / wordBits] >> (receiver % wordBits) & 1)) {
+			return slots();
+		}
+		return receiver;
+	}
+
+	const auto found = std::lower_bound(m_indices.begin(), m_indices.end(), receiver);
+	if (found == m_indices.end() || *found != receiver) {
+		return slots();
+	}
+
+	return static_cast<std::uint32_t>(found - m_indices.begin());
+}
+
+std::uint32_t multicast::ReceiverSet::slots() const {
+	return isDense() ? m_universe : m_count;
+}
+
+multicast::Delivery::Delivery(const ReceiverSet& receivers)
+	: m_words(new std::atomic<std::uint64_t>[(receivers.slots() + 63) / 64]), m_pending(receivers.count()) {
+	for (std::uint32_t i = 0; i < (receivers.slots() + 63) / 64; i++) {
+		m_words[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+bool multicast::Delivery::mark(const std::uint32_t slot) {
+	const auto bit = std::uint64_t(1) << (slot % 64);
+	if (m_words[slot / 64].fetch_or(bit, std::memory_order_relaxed) & bit) {
+		return false;
+	}
+
+	m_pending.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+bool multicast::Delivery::isMarked(const std::uint32_t slot) const {
+	return (m_words[slot / 64].load(std::memory_order_relaxed) >> (slot % 64) & 1) != 0;
+}
+
+std::uint32_t multicast::Delivery::pending() const {
+	return m_pending.load(std::memory_order_acquire);
+}
+
+multicast::MulticastMessage::MulticastMessage(const int size, const std::uint32_t sender, const ReceiverSet& receivers,
+	const double sentAt)
+	: m_header(std::make_shared<const Header>(Header{ size, sender, sentAt, payload::Payload() })),
+	m_receivers(std::make_shared<const ReceiverSet>(receivers)),
+	m_delivery(std::make_shared<Delivery>(receivers)) {
+	if (size < 0) {
+		throw std::invalid_argument("size should be non-negative");
+	}
+
+	if (sender >= receivers.universe()) {
+		throw std::invalid_argument("sender index should be less than universe");
+	}
+}
+
+multicast::MulticastMessage::MulticastMessage(const payload::Payload& body, const std::uint32_t sender,
+	const ReceiverSet& receivers, const double sentAt)
+	: m_header(std::make_shared<const Header>(Header{ static_cast<int>(body.size()), sender, sentAt, body })),
+	m_receivers(std::make_shared<const ReceiverSet>(receivers)),
+	m_delivery(std::make_shared<Delivery>(receivers)) {
+	if (sender >= receivers.universe()) {
+		throw std::invalid_argument("sender index should be less than universe");
+	}
+}
+
+multicast::MulticastMessage::MulticastMessage(const MulticastMessage& message) noexcept
+	: Identifiable(message), m_header(message.m_header), m_receivers(message.m_receivers), m_delivery(message.m_delivery) {
+}
+
+int multicast::MulticastMessage::size() const {
+	return m_header->size;
+}
+
+std::uint32_t multicast::MulticastMessage::sender() const {
+	return m_header->sender;
+}
+
+double multicast::MulticastMessage::sentAt() const {
+	return m_header->sentAt;
+}
+
+const payload::Payload& multicast::MulticastMessage::body() const {
+	return m_header->body;
+}
+
+const multicast::ReceiverSet& multicast::MulticastMessage::receivers() const {
+	return *m_receivers;
+}
+
+bool multicast::MulticastMessage::markDelivered(const std::uint32_t receiver) {
+	const auto slot = m_receivers->slotOf(receiver);
+	return slot < m_receivers->slots() && m_delivery->mark(slot);
+}
+
+bool multicast::MulticastMessage::isDelivered(const std::uint32_t receiver) const {
+	const auto slot = m_receivers->slotOf(receiver);
+	return slot < m_receivers->slots() && m_delivery->isMarked(slot);
+}
+
+std::uint32_t multicast::MulticastMessage::pending() const {
+	return m_delivery->pending();
+}
+
+bool multicast::MulticastMessage::isComplete() const {
+	return pending() == 0;
+}
+
+std::vector<entities::Message> multicast::MulticastMessage::expand(const std::vector<entities::Node>& nodes) const {
+	if (m_receivers->universe() > nodes.size()) {
+		throw std::invalid_argument("nodes should cover receiver universe");
+	}
+
+	boost::uuids::random_generator generator;
+	const auto body = std::make_shared<const payload::Payload>(m_header->body);
+	const auto sender = std::make_shared<const entities::Node>(nodes[m_header->sender].id());
+	std::vector<entities::Message> messages;
+	messages.reserve(m_receivers->count());
+
+	m_receivers->forEach([&](const std::uint32_t receiver) {
+		messages.emplace_back(generator(), m_header->size, sender, std::make_shared<const entities::Node>(nodes[receiver].id()));
+		messages.back().setSentAt(m_header->sentAt);
+		if (!body->isEmpty()) {
+			messages.back().setPayload(body);
+		}
+	});
+
+	return messages;
+}
@@ -0,0 +1,112 @@
+#ifndef _MULTICAST_H_
+#define _MULTICAST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bits.h"
+#include "entities.h"
+#include "interfaces.h"
+#include "payload.h"
+
+namespace multicast {
+	class ReceiverSet {
+	public:
+		ReceiverSet();
+		ReceiverSet(std::vector<std::uint32_t> receivers, std::uint32_t universe);
+
+		static ReceiverSet							all(std::uint32_t universe, std::uint32_t except);
+
+		std::uint32_t								universe() const;
+		std::uint32_t								count() const;
+		bool										isDense() const;
+
+		bool										contains(std::uint32_t receiver) const;
+		std::uint32_t								slotOf(std::uint32_t receiver) const;
+		std::uint32_t								slots() const;
+
+		template<typename Function>
+		void										forEach(Function function) const;
+
+	private:
+		static const std::uint32_t					wordBits = 64;
+
+		std::uint32_t								m_universe;
+		std::uint32_t								m_count;
+		std::vector<std::uint64_t>					m_bits;
+		std::vector<std::uint32_t>					m_indices;
+	};
+
+	struct Header {
+		int											size;
+		std::uint32_t								sender;
+		double										sentAt;
+		payload::Payload							body;
+	};
+
+	class Delivery {
+	public:
+		explicit Delivery(const ReceiverSet& receivers);
+
+		Delivery(const Delivery&) = delete;
+		const Delivery&								operator=(const Delivery&) = delete;
+
+		bool										mark(std::uint32_t slot);
+		bool										isMarked(std::uint32_t slot) const;
+		std::uint32_t								pending() const;
+
+	private:
+		std::unique_ptr<std::atomic<std::uint64_t>[]>	m_words;
+		std::atomic<std::uint32_t>					m_pending;
+	};
+
+	class MulticastMessage : public interfaces::Identifiable {
+	public:
+		MulticastMessage(const int size, const std::uint32_t sender, const ReceiverSet& receivers, const double sentAt = 0);
+		MulticastMessage(const payload::Payload& body, const std::uint32_t sender, const ReceiverSet& receivers,
+			const double sentAt = 0);
+		MulticastMessage(const MulticastMessage& message) noexcept;
+
+		int											size() const;
+		std::uint32_t								sender() const;
+		double										sentAt() const;
+		const payload::Payload&						body() const;
+		const ReceiverSet&							receivers() const;
+
+		bool										markDelivered(std::uint32_t receiver);
+		bool										isDelivered(std::uint32_t receiver) const;
+		std::uint32_t								pending() const;
+		bool										isComplete() const;
+
+		std::vector<entities::Message>				expand(const std::vector<entities::Node>& nodes) const;
+
+	private:
+		std::shared_ptr<const Header>				m_header;
+		std::shared_ptr<const ReceiverSet>			m_receivers;
+		std::shared_ptr<Delivery>					m_delivery;
+	};
+
+	template <typename Function>
+	void ReceiverSet::forEach(Function function) const {
+		if (!isDense()) {
+			for (auto receiver : m_indices) {
+				function(receiver);
+			}
+			return;
+		}
+
+		for (std::size_t word = 0; word < m_bits.size(); word++) {
+			auto bits = m_bits[word];
+			while (bits != 0) {
+				const auto lowest = bits & (~bits + 1);
+				function(static_cast<std::uint32_t>(word * wordBits + bits::highest(lowest)));
+				bits ^= lowest;
+			}
+		}
+	}
+}
+
+#endif
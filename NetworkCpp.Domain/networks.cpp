@@ -0,0 +1,329 @@
+#include "networks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "rng.h"
+
+namespace {
+	// work is cut into a fixed number of blocks with their own seeds, so the result does not depend on thread count
+	const std::size_t blockCount = 256;
+
+	std::uint64_t hash(const std::uint64_t seed, const std::uint64_t counter) {
+		return rng::mix(seed ^ rng::mix(counter + 0x9e3779b97f4a7c15ull));
+	}
+
+	void connect(std::vector<topology::Link>& links, const std::uint32_t first, const std::uint32_t second) {
+		links.push_back(topology::Link{ first, second });
+		links.push_back(topology::Link{ second, first });
+	}
+
+	template<typename Emit>
+	std::vector<topology::Link> emitBlocks(const std::size_t blocks, unsigned threads, Emit emit) {
+		std::vector<std::vector<topology::Link>> results(blocks);
+		std::atomic<std::size_t> next(0);
+
+		const auto work = [&]() {
+			for (auto block = next++; block < blocks; block = next++) {
+				emit(block, results[block]);
+			}
+		};
+
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threads = static_cast<unsigned>(std::min<std::size_t>(threads, blocks));
+
+		std::vector<std::thread> workers;
+		for (unsigned i = 1; i < threads; i++) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+
+		std::size_t total = 0;
+		for (const auto& result : results) {
+			total += result.size();
+		}
+
+		std::vector<topology::Link> links;
+		links.reserve(total);
+		for (auto& result : results) {
+			links.insert(links.end(), result.begin(), result.end());
+			std::vector<topology::Link>().swap(result);
+		}
+
+		return links;
+	}
+
+	std::vector<std::uint32_t> balancedRows(const std::uint32_t nodeCount) {
+		// row v holds n - 1 - v candidate pairs, boundaries split the triangle into equal shares
+		const auto total = static_cast<double>(nodeCount) * (nodeCount - 1) / 2;
+		std::vector<std::uint32_t> rows(1, 0);
+		double pairs = 0;
+
+		for (std::uint32_t row = 0; row < nodeCount; row++) {
+			pairs += nodeCount - 1 - row;
+			if (pairs >= total * rows.size() / blockCount && rows.size() < blockCount) {
+				rows.push_back(row + 1);
+			}
+		}
+
+		while (rows.size() <= blockCount) {
+			rows.push_back(nodeCount);
+		}
+
+		return rows;
+	}
+
+	template<typename Accept>
+	void skipPairs(const std::uint32_t nodeCount, const std::uint32_t rowBegin, const std::uint32_t rowEnd,
+		const double probability, rng::Xoshiro256& random, std::vector<topology::Link>& links, Accept accept) {
+		if (probability <= 0 || rowBegin >= rowEnd) {
+			return;
+		}
+
+		// geometric skips jump straight to the next sampled pair instead of drawing a number for every pair
+		const auto logMiss = probability < 1 ? std::log1p(-probability) : 0;
+		std::uint64_t column = rowBegin;
+		std::uint32_t row = rowBegin;
+
+		for (;;) {
+			const auto skip = probability < 1 ? std::floor(std::log(random.nextUnit()) / logMiss) : 0;
+			column += 1 + static_cast<std::uint64_t>(std::min(skip, 1e18));
+
+			while (column >= nodeCount && row < rowEnd) {
+				column = column - nodeCount + row + 2;
+				row++;
+			}
+
+			if (row >= rowEnd) {
+				return;
+			}
+
+			if (accept(row, static_cast<std::uint32_t>(column))) {
+				connect(links, row, static_cast<std::uint32_t>(column));
+			}
+		}
+	}
+}
+
+std::vector<entities::Node> networks::nodes(const std::uint32_t count, const std::uint64_t seed) {
+	rng::Xoshiro256 random(seed);
+	std::vector<entities::Node> result;
+	result.reserve(count);
+
+	for (std::uint32_t i = 0; i < count; i++) {
+		const std::uint64_t words[] = { random(), random() };
+		boost::uuids::uuid id;
+		std::memcpy(id.data, words, sizeof(words));
+
+		// version 4 and RFC 4122 variant, the same layout the random generator produces
+		id.data[6] = static_cast<std::uint8_t>((id.data[6] & 0x0f) | 0x40);
+		id.data[8] = static_cast<std::uint8_t>((id.data[8] & 0x3f) | 0x80);
+		result.emplace_back(id);
+	}
+
+	return result;
+}
+
+topology::Graph networks::erdosRenyi(const std::uint32_t nodeCount, const double probability, const std::uint64_t seed,
+	const unsigned threads) {
+	if (probability < 0 || probability > 1) {
+		throw std::invalid_argument("probability should be within [0, 1]");
+	}
+
+	const auto rows = balancedRows(nodeCount);
+	const auto links = emitBlocks(blockCount, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		rng::Xoshiro256 random(hash(seed, block));
+		skipPairs(nodeCount, rows[block], rows[block + 1], probability, random, out,
+			[](std::uint32_t, std::uint32_t) { return true; });
+	});
+
+	return topology::Graph(nodeCount, links);
+}
+
+topology::Graph networks::barabasiAlbert(const std::uint32_t nodeCount, const std::uint32_t linksPerNode,
+	const std::uint64_t seed, const unsigned threads) {
+	if (linksPerNode == 0 || static_cast<std::uint64_t>(nodeCount) * linksPerNode * 2 >= topology::Graph::none) {
+		throw std::invalid_argument("links per node should be positive and fit the link index");
+	}
+
+	// copy model over a virtual edge list where slot 2i is the new node of edge i and slot 2i + 1 copies an earlier
+	// slot; each slot is drawn from a counter based hash, so edges resolve independently and in any order
+	const auto target = [&](std::uint64_t edge) {
+		while (edge > 0) {
+			const auto slot = rng::toIndex(hash(seed, edge), static_cast<std::uint32_t>(edge * 2));
+			if (slot % 2 == 0) {
+				return static_cast<std::uint32_t>(slot / 2 / linksPerNode);
+			}
+			edge = slot / 2;
+		}
+		return 0u;
+	};
+
+	const std::uint64_t edgeCount = static_cast<std::uint64_t>(nodeCount) * linksPerNode;
+	const auto links = emitBlocks(blockCount, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		const auto begin = edgeCount * block / blockCount;
+		const auto end = edgeCount * (block + 1) / blockCount;
+		out.reserve((end - begin) * 2);
+
+		for (auto edge = begin; edge < end; edge++) {
+			connect(out, static_cast<std::uint32_t>(edge / linksPerNode), target(edge));
+		}
+	});
+
+	return topology::Graph(nodeCount, links);
+}
+
+topology::Graph networks::waxman(const std::uint32_t nodeCount, const double alpha, const double beta,
+	const std::uint64_t seed, const unsigned threads) {
+	if (alpha <= 0 || beta < 0 || beta > 1) {
+		throw std::invalid_argument("alpha should be positive and beta within [0, 1]");
+	}
+
+	std::vector<double> x(nodeCount);
+	std::vector<double> y(nodeCount);
+	for (std::uint32_t node = 0; node < nodeCount; node++) {
+		x[node] = rng::toUnit(hash(seed, node * 2ull));
+		y[node] = rng::toUnit(hash(seed, node * 2ull + 1));
+	}
+
+	// pairs are sampled at the upper bound beta and thinned by distance, so the cost follows the expected link count
+	const auto scale = alpha * std::sqrt(2.0);
+	const auto rows = balancedRows(nodeCount);
+	const auto links = emitBlocks(blockCount, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		rng::Xoshiro256 random(hash(~seed, block));
+		skipPairs(nodeCount, rows[block], rows[block + 1], beta, random, out,
+			[&](const std::uint32_t first, const std::uint32_t second) {
+				const auto distance = std::hypot(x[first] - x[second], y[first] - y[second]);
+				return random.nextUnit() <= std::exp(-distance / scale);
+			});
+	});
+
+	return topology::Graph(nodeCount, links);
+}
+
+topology::Graph networks::torus(const std::vector<std::uint32_t>& dimensions, const unsigned threads) {
+	if (dimensions.empty() || dimensions.size() > 3) {
+		throw std::invalid_argument("torus should have one to three dimensions");
+	}
+
+	std::uint64_t nodeCount = 1;
+	for (auto dimension : dimensions) {
+		if (dimension == 0) {
+			throw std::invalid_argument("torus dimensions should be positive");
+		}
+		nodeCount *= dimension;
+	}
+
+	if (nodeCount * dimensions.size() * 2 >= topology::Graph::none) {
+		throw std::invalid_argument("torus is too large");
+	}
+
+	const auto links = emitBlocks(blockCount, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		const auto begin = nodeCount * block / blockCount;
+		const auto end = nodeCount * (block + 1) / blockCount;
+		out.reserve((end - begin) * dimensions.size() * 2);
+
+		for (auto node = begin; node < end; node++) {
+			std::uint64_t stride = 1;
+			for (auto dimension : dimensions) {
+				const auto coordinate = node / stride % dimension;
+				const auto neighbour = node - coordinate * stride + (coordinate + 1) % dimension * stride;
+				connect(out, static_cast<std::uint32_t>(node), static_cast<std::uint32_t>(neighbour));
+				stride *= dimension;
+			}
+		}
+	});
+
+	return topology::Graph(static_cast<std::uint32_t>(nodeCount), links);
+}
+
+topology::Graph networks::fatTree(const std::uint32_t ports, const unsigned threads) {
+	if (ports < 2 || ports % 2 != 0 || ports > 256) {
+		throw std::invalid_argument("fat tree ports should be even and within [2, 256]");
+	}
+
+	// hosts first, then edge, aggregation and core switches
+	const auto half = ports / 2;
+	const auto hosts = ports * ports * ports / 4;
+	const auto edges = hosts;
+	const auto aggregations = hosts + ports * half;
+	const auto cores = aggregations + ports * half;
+
+	// one block per pod, with the pod's hosts and its uplinks to the core
+	const auto links = emitBlocks(ports, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		const auto pod = static_cast<std::uint32_t>(block);
+		out.reserve(static_cast<std::size_t>(half) * half * 6);
+
+		for (auto host = pod * half * half; host < (pod + 1) * half * half; host++) {
+			connect(out, host, edges + host / half);
+		}
+
+		for (std::uint32_t edge = 0; edge < half; edge++) {
+			for (std::uint32_t aggregation = 0; aggregation < half; aggregation++) {
+				connect(out, edges + pod * half + edge, aggregations + pod * half + aggregation);
+			}
+		}
+
+		for (std::uint32_t aggregation = 0; aggregation < half; aggregation++) {
+			for (std::uint32_t core = 0; core < half; core++) {
+				connect(out, aggregations + pod * half + aggregation, cores + aggregation * half + core);
+			}
+		}
+	});
+
+	return topology::Graph(cores + half * half, links);
+}
+
+topology::Graph networks::dragonfly(const std::uint32_t routersPerGroup, const std::uint32_t hostsPerRouter,
+	const std::uint32_t globalLinksPerRouter, const unsigned threads) {
+	if (routersPerGroup == 0 || globalLinksPerRouter == 0) {
+		throw std::invalid_argument("dragonfly should have routers and global links");
+	}
+
+	// the largest balanced configuration: every group has one global link to each other group
+	const std::uint64_t groups = static_cast<std::uint64_t>(routersPerGroup) * globalLinksPerRouter + 1;
+	const auto routers = groups * routersPerGroup;
+	const auto nodeCount = routers * (1 + hostsPerRouter);
+	if (nodeCount >= topology::Graph::none) {
+		throw std::invalid_argument("dragonfly is too large");
+	}
+
+	// blocks take a range of groups, each group emits its local clique, its hosts and the global links to later groups
+	const auto links = emitBlocks(blockCount, threads, [&](const std::size_t block, std::vector<topology::Link>& out) {
+		const auto begin = groups * block / blockCount;
+		const auto end = groups * (block + 1) / blockCount;
+		out.reserve(static_cast<std::size_t>((end - begin) * routersPerGroup * (routersPerGroup + globalLinksPerRouter + hostsPerRouter)));
+
+		for (auto group = begin; group < end; group++) {
+			const auto first = group * routersPerGroup;
+			for (std::uint32_t i = 0; i < routersPerGroup; i++) {
+				for (std::uint32_t j = i + 1; j < routersPerGroup; j++) {
+					connect(out, static_cast<std::uint32_t>(first + i), static_cast<std::uint32_t>(first + j));
+				}
+
+				const auto router = first + i;
+				for (std::uint32_t host = 0; host < hostsPerRouter; host++) {
+					connect(out, static_cast<std::uint32_t>(router), static_cast<std::uint32_t>(routers + router * hostsPerRouter + host));
+				}
+			}
+
+			// global port k of a group leads to group k, skipping the group itself
+			for (auto other = group + 1; other < groups; other++) {
+				const auto from = first + (other - 1) / globalLinksPerRouter;
+				const auto to = other * routersPerGroup + group / globalLinksPerRouter;
+				connect(out, static_cast<std::uint32_t>(from), static_cast<std::uint32_t>(to));
+			}
+		}
+	});
+
+	return topology::Graph(static_cast<std::uint32_t>(nodeCount), links);
+}
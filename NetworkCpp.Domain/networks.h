@@ -0,0 +1,25 @@
+#ifndef _NETWORKS_H_
+#define _NETWORKS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "entities.h"
+#include "topology.h"
+
+namespace networks {
+	std::vector<entities::Node>						nodes(std::uint32_t count, std::uint64_t seed);
+
+	topology::Graph									erdosRenyi(std::uint32_t nodeCount, double probability, std::uint64_t seed,
+														unsigned threads = 0);
+	topology::Graph									barabasiAlbert(std::uint32_t nodeCount, std::uint32_t linksPerNode,
+														std::uint64_t seed, unsigned threads = 0);
+	topology::Graph									waxman(std::uint32_t nodeCount, double alpha, double beta, std::uint64_t seed,
+														unsigned threads = 0);
+	topology::Graph									torus(const std::vector<std::uint32_t>& dimensions, unsigned threads = 0);
+	topology::Graph									fatTree(std::uint32_t ports, unsigned threads = 0);
+	topology::Graph									dragonfly(std::uint32_t routersPerGroup, std::uint32_t hostsPerRouter,
+														std::uint32_t globalLinksPerRouter, unsigned threads = 0);
+}
+
+#endif
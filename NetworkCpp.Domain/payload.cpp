@@ -0,0 +1,354 @@
+#include "payload.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace {
+	const std::size_t alignment = alignof(std::max_align_t);
+
+	std::size_t roundUp(const std::size_t value) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	const std::size_t chunkHeaderSize = roundUp(sizeof(payload::Chunk));
+}
+
+struct payload::SlabPool::State {
+	std::size_t										chunkSize;
+	std::size_t										chunksPerSlab;
+	std::size_t										headroom;
+	std::size_t										stride;
+
+	std::mutex										mutex;
+	std::vector<std::unique_ptr<unsigned char[]>>	slabs;
+	std::vector<Chunk*>								free;
+
+	// the pool itself plus every chunk handed out, so slabs outlive the pool while buffers are alive
+	std::atomic<std::size_t>						users;
+};
+
+payload::Buffer::Buffer()
+	: m_chunk(nullptr), m_offset(0), m_length(0) {
+}
+
+payload::Buffer::Buffer(Buffer&& buffer) noexcept
+	: m_chunk(buffer.m_chunk), m_offset(buffer.m_offset), m_length(buffer.m_length) {
+	buffer.m_chunk = nullptr;
+	buffer.m_offset = 0;
+	buffer.m_length = 0;
+}
+
+payload::Buffer::Buffer(Chunk* chunk, const std::size_t offset, const std::size_t length)
+	: m_chunk(chunk), m_offset(static_cast<std::uint32_t>(offset)), m_length(static_cast<std::uint32_t>(length)) {
+}
+
+payload::Buffer& payload::Buffer::operator=(Buffer buffer) noexcept {
+	std::swap(m_chunk, buffer.m_chunk);
+	std::swap(m_offset, buffer.m_offset);
+	std::swap(m_length, buffer.m_length);
+	return *this;
+}
+
+unsigned char* payload::Buffer::mutableData() {
+	if (!m_chunk) {
+		return nullptr;
+	}
+
+	if (!isUnique()) {
+		throw std::logic_error("shared buffer cannot be modified");
+	}
+
+	return m_chunk->data() + m_offset;
+}
+
+std::size_t payload::Buffer::headroom() const {
+	return m_offset;
+}
+
+bool payload::Buffer::isEmpty() const {
+	return m_length == 0;
+}
+
+bool payload::Buffer::isUnique() const {
+	return m_chunk && m_chunk->references.load(std::memory_order_acquire) == 1;
+}
+
+payload::Buffer payload::Buffer::slice(const std::size_t offset, const std::size_t length) const {
+	if (offset > m_length || length > m_length - offset) {
+		throw std::out_of_range("slice should be within buffer");
+	}
+
+	if (m_chunk) {
+		m_chunk->references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return Buffer(m_chunk, m_offset + offset, length);
+}
+
+bool payload::Buffer::tryPrepend(const std::size_t length) {
+	if (!isUnique() || length > m_offset) {
+		return false;
+	}
+
+	m_offset -= static_cast<std::uint32_t>(length);
+	m_length += static_cast<std::uint32_t>(length);
+	return true;
+}
+
+void payload::Buffer::strip(const std::size_t length) {
+	if (length > m_length) {
+		throw std::out_of_range("cannot strip more than buffer size");
+	}
+
+	m_offset += static_cast<std::uint32_t>(length);
+	m_length -= static_cast<std::uint32_t>(length);
+}
+
+void payload::Buffer::truncate(const std::size_t length) {
+	if (length > m_length) {
+		throw std::out_of_range("cannot truncate beyond buffer size");
+	}
+
+	m_length = static_cast<std::uint32_t>(length);
+}
+
+payload::SlabPool::SlabPool(const std::size_t chunkSize, const std::size_t chunksPerSlab, const std::size_t headroom)
+	: m_state(new State()) {
+	if (chunkSize == 0 || chunksPerSlab == 0 || headroom >= chunkSize
+		|| chunkSize > std::numeric_limits<std::uint32_t>::max()) {
+		delete m_state;
+		throw std::invalid_argument("chunk should be non-empty and larger than headroom");
+	}
+
+	m_state->chunkSize = chunkSize;
+	m_state->chunksPerSlab = chunksPerSlab;
+	m_state->headroom = headroom;
+	m_state->stride = chunkHeaderSize + roundUp(chunkSize);
+	m_state->users.store(1, std::memory_order_relaxed);
+}
+
+payload::SlabPool::~SlabPool() {
+	if (m_state->users.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete m_state;
+	}
+}
+
+payload::Buffer payload::SlabPool::allocate(const std::size_t size) {
+	if (size > std::numeric_limits<std::uint32_t>::max() - m_state->headroom) {
+		throw std::invalid_argument("payload segment is too large");
+	}
+
+	Chunk* chunk;
+	if (m_state->headroom + size > m_state->chunkSize) {
+		// oversized payloads get a dedicated chunk rather than a chain of slab chunks
+		chunk = new (::operator new(chunkHeaderSize + m_state->headroom + size)) Chunk;
+		chunk->owner = nullptr;
+		chunk->capacity = m_state->headroom + size;
+	}
+	else {
+		{
+			std::lock_guard<std::mutex> lock(m_state->mutex);
+			if (m_state->free.empty()) {
+				std::unique_ptr<unsigned char[]> slab(new unsigned char[m_state->stride * m_state->chunksPerSlab]);
+				for (auto i = m_state->chunksPerSlab; i > 0; i--) {
+					auto slabChunk = new (slab.get() + m_state->stride * (i - 1)) Chunk;
+					slabChunk->owner = m_state;
+					slabChunk->capacity = m_state->chunkSize;
+					m_state->free.push_back(slabChunk);
+				}
+				m_state->slabs.push_back(std::move(slab));
+			}
+
+			chunk = m_state->free.back();
+			m_state->free.pop_back();
+		}
+		m_state->users.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	chunk->references.store(1, std::memory_order_relaxed);
+	return Buffer(chunk, m_state->headroom, size);
+}
+
+payload::Buffer payload::SlabPool::copyOf(const void* data, const std::size_t size) {
+	auto buffer = allocate(size);
+	if (size > 0) {
+		std::memcpy(buffer.mutableData(), data, size);
+	}
+	return buffer;
+}
+
+std::size_t payload::SlabPool::chunkSize() const {
+	return m_state->chunkSize;
+}
+
+std::size_t payload::SlabPool::headroom() const {
+	return m_state->headroom;
+}
+
+std::size_t payload::SlabPool::slabCount() const {
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->slabs.size();
+}
+
+std::size_t payload::SlabPool::freeCount() const {
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->free.size();
+}
+
+payload::SlabPool& payload::SlabPool::shared() {
+	static SlabPool pool;
+	return pool;
+}
+
+void payload::SlabPool::release(Chunk* chunk) {
+	auto state = static_cast<State*>(chunk->owner);
+	if (!state) {
+		chunk->~Chunk();
+		::operator delete(chunk);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->free.push_back(chunk);
+	}
+
+	if (state->users.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete state;
+	}
+}
+
+payload::Payload::Payload()
+	: m_size(0) {
+}
+
+payload::Payload::Payload(const Buffer& buffer)
+	: m_size(0) {
+	append(buffer);
+}
+
+std::size_t payload::Payload::size() const {
+	return m_size;
+}
+
+bool payload::Payload::isEmpty() const {
+	return m_size == 0;
+}
+
+std::size_t payload::Payload::segmentCount() const {
+	return m_segments.size();
+}
+
+const payload::Buffer& payload::Payload::segment(const std::size_t index) const {
+	return m_segments.at(index);
+}
+
+void payload::Payload::append(const Buffer& buffer) {
+	if (buffer.isEmpty()) {
+		return;
+	}
+
+	m_segments.push_back(buffer);
+	m_size += buffer.size();
+}
+
+void payload::Payload::append(const Payload& payload) {
+	for (const auto& segment : payload.m_segments) {
+		append(segment);
+	}
+}
+
+void payload::Payload::prepend(const Buffer& buffer) {
+	if (buffer.isEmpty()) {
+		return;
+	}
+
+	m_segments.insert(m_segments.begin(), buffer);
+	m_size += buffer.size();
+}
+
+void payload::Payload::prepend(const void* header, const std::size_t length, SlabPool& pool) {
+	if (length == 0) {
+		return;
+	}
+
+	// a header written by the previous hop into a fresh segment leaves headroom for the next one
+	if (!m_segments.empty() && m_segments.front().tryPrepend(length)) {
+		std::memcpy(m_segments.front().mutableData(), header, length);
+		m_size += length;
+		return;
+	}
+
+	prepend(pool.copyOf(header, length));
+}
+
+void payload::Payload::strip(std::size_t length) {
+	if (length > m_size) {
+		throw std::out_of_range("cannot strip more than payload size");
+	}
+
+	m_size -= length;
+
+	auto consumed = m_segments.begin();
+	while (length > 0 && length >= consumed->size()) {
+		length -= consumed->size();
+		++consumed;
+	}
+	m_segments.erase(m_segments.begin(), consumed);
+
+	if (length > 0) {
+		m_segments.front().strip(length);
+	}
+}
+
+payload::Payload payload::Payload::slice(std::size_t offset, std::size_t length) const {
+	if (offset > m_size || length > m_size - offset) {
+		throw std::out_of_range("slice should be within payload");
+	}
+
+	Payload result;
+	for (auto segment = m_segments.begin(); segment != m_segments.end() && length > 0; ++segment) {
+		if (offset >= segment->size()) {
+			offset -= segment->size();
+			continue;
+		}
+
+		const auto taken = std::min(length, segment->size() - offset);
+		result.append(segment->slice(offset, taken));
+		offset = 0;
+		length -= taken;
+	}
+
+	return result;
+}
+
+std::size_t payload::Payload::copyTo(void* destination, std::size_t offset, std::size_t length) const {
+	auto output = static_cast<unsigned char*>(destination);
+	std::size_t copied = 0;
+
+	for (auto segment = m_segments.begin(); segment != m_segments.end() && length > 0; ++segment) {
+		if (offset >= segment->size()) {
+			offset -= segment->size();
+			continue;
+		}
+
+		const auto taken = std::min(length, segment->size() - offset);
+		std::memcpy(output + copied, segment->data() + offset, taken);
+		copied += taken;
+		offset = 0;
+		length -= taken;
+	}
+
+	return copied;
+}
+
+std::vector<unsigned char> payload::Payload::bytes() const {
+	std::vector<unsigned char> result(m_size);
+	copyTo(result.data(), 0, m_size);
+	return result;
+}
@@ -0,0 +1,137 @@
+#ifndef _PAYLOAD_H_
+#define _PAYLOAD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace payload {
+	struct Chunk {
+		std::atomic<std::uint32_t>					references;
+		void*										owner;
+		std::size_t									capacity;
+
+		unsigned char*								data();
+	};
+
+	class Buffer {
+	public:
+		Buffer();
+		Buffer(const Buffer& buffer) noexcept;
+		Buffer(Buffer&& buffer) noexcept;
+
+		~Buffer();
+
+		Buffer&										operator=(Buffer buffer) noexcept;
+
+		const unsigned char*						data() const;
+		unsigned char*								mutableData();
+		std::size_t									size() const;
+		std::size_t									headroom() const;
+		bool										isEmpty() const;
+		bool										isUnique() const;
+
+		Buffer										slice(std::size_t offset, std::size_t length) const;
+		bool										tryPrepend(std::size_t length);
+		void										strip(std::size_t length);
+		void										truncate(std::size_t length);
+
+	private:
+		friend class SlabPool;
+
+		Buffer(Chunk* chunk, std::size_t offset, std::size_t length);
+
+		Chunk*										m_chunk;
+		std::uint32_t								m_offset;
+		std::uint32_t								m_length;
+	};
+
+	class SlabPool {
+	public:
+		explicit SlabPool(std::size_t chunkSize = 2048, std::size_t chunksPerSlab = 64, std::size_t headroom = 64);
+		SlabPool(const SlabPool&) = delete;
+
+		~SlabPool();
+
+		const SlabPool&								operator=(const SlabPool&) = delete;
+
+		Buffer										allocate(std::size_t size);
+		Buffer										copyOf(const void* data, std::size_t size);
+
+		std::size_t									chunkSize() const;
+		std::size_t									headroom() const;
+		std::size_t									slabCount() const;
+		std::size_t									freeCount() const;
+
+		static SlabPool&							shared();
+		static void									release(Chunk* chunk);
+
+	private:
+		struct State;
+
+		State*										m_state;
+	};
+
+	class Payload {
+	public:
+		Payload();
+		explicit Payload(const Buffer& buffer);
+
+		std::size_t									size() const;
+		bool										isEmpty() const;
+		std::size_t									segmentCount() const;
+		const Buffer&								segment(std::size_t index) const;
+
+		void										append(const Buffer& buffer);
+		void										append(const Payload& payload);
+		void										prepend(const Buffer& buffer);
+		void										prepend(const void* header, std::size_t length, SlabPool& pool = SlabPool::shared());
+		void										strip(std::size_t length);
+
+		Payload										slice(std::size_t offset, std::size_t length) const;
+		std::size_t									copyTo(void* destination, std::size_t offset, std::size_t length) const;
+		std::vector<unsigned char>					bytes() const;
+
+		template<typename Function>
+		void										forEach(Function function) const;
+
+	private:
+		std::vector<Buffer>							m_segments;
+		std::size_t									m_size;
+	};
+
+	inline unsigned char* Chunk::data() {
+		return reinterpret_cast<unsigned char*>(this) + ((sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1));
+	}
+
+	inline Buffer::Buffer(const Buffer& buffer) noexcept
+		: m_chunk(buffer.m_chunk), m_offset(buffer.m_offset), m_length(buffer.m_length) {
+		if (m_chunk) {
+			m_chunk->references.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	inline Buffer::~Buffer() {
+		if (m_chunk && m_chunk->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			SlabPool::release(m_chunk);
+		}
+	}
+
+	inline const unsigned char* Buffer::data() const {
+		return m_chunk ? m_chunk->data() + m_offset : nullptr;
+	}
+
+	inline std::size_t Buffer::size() const {
+		return m_length;
+	}
+
+	template <typename Function>
+	void Payload::forEach(Function function) const {
+		for (const auto& segment : m_segments) {
+			function(segment.data(), segment.size());
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,290 @@
+#include "queueing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+	const std::size_t			maxTerms = 1 << 20;
+	const double				negligible = 1e-30;
+	const double				rescaleAbove = 1e100;
+	const double				smallestIdle = 1e-250;
+
+	// tails[j] is the probability of more than j arrivals during one service, gamma service gives a negative
+	// binomial count and deterministic service its poisson limit
+	std::vector<double> arrivalTails(const double rate, const double mean, const double scv, const std::size_t count,
+		double& none) {
+		const auto expected = rate * mean;
+		const auto shape = scv > 0 ? 1.0 / scv : 0.0;
+		const auto scaled = expected * scv;
+		auto logTerm = scv > 0 ? -shape * std::log1p(scaled) : -expected;
+
+		std::vector<double> terms;
+		for (std::size_t j = 0; j < maxTerms; j++) {
+			const auto term = std::exp(logTerm);
+			terms.push_back(term);
+			if (j + 1 >= count && j > expected && term < negligible) {
+				break;
+			}
+
+			logTerm += scv > 0 ? std::log((j + shape) / (j + 1) * scaled / (1 + scaled)) : std::log(expected / (j + 1));
+		}
+
+		// summing from the far end keeps small tails exact instead of losing them in 1 - sum
+		auto total = 0.0;
+		for (auto term : terms) {
+			total += term;
+		}
+
+		std::vector<double> tails(count);
+		auto above = std::max(0.0, 1.0 - total);
+		for (auto j = terms.size(); j > 0; j--) {
+			if (j - 1 < count) {
+				tails[j - 1] = above;
+			}
+			above += terms[j - 1];
+		}
+		for (auto j = terms.size(); j < count; j++) {
+			tails[j] = std::max(0.0, 1.0 - total);
+		}
+
+		none = std::max(terms[0], smallestIdle);
+		return tails;
+	}
+
+	queueing::Estimate estimateOf(const std::size_t capacity, const double rate, const double mean, const double full,
+		const double occupancy) {
+		const auto throughput = rate * (1 - full);
+		const auto sojourn = throughput > 0 ? occupancy / throughput : 0.0;
+
+		return queueing::Estimate{ capacity, throughput * mean, occupancy, full, throughput,
+			std::max(0.0, sojourn - mean), sojourn, queueing::Reliable };
+	}
+}
+
+queueing::Estimate queueing::mm1k(const double arrivalRate, const double serviceRate, const std::size_t capacity) {
+	if (arrivalRate <= 0 || serviceRate <= 0 || capacity == 0) {
+		throw std::invalid_argument("rates and capacity should be positive");
+	}
+
+	const auto load = arrivalRate / serviceRate;
+	double full;
+	double occupancy;
+	if (std::abs(load - 1) < 1e-9) {
+		full = 1.0 / (capacity + 1);
+		occupancy = capacity / 2.0;
+	}
+	else {
+		// above saturation the distribution is mirrored, so powers of the inverse load never overflow
+		const auto ratio = load < 1 ? load : 1 / load;
+		const auto top = std::pow(ratio, static_cast<double>(capacity + 1));
+		const auto mirrored = ratio / (1 - ratio) - (capacity + 1) * top / (1 - top);
+
+		full = load < 1 ? (1 - ratio) * std::pow(ratio, static_cast<double>(capacity)) / (1 - top) : (1 - ratio) / (1 - top);
+		occupancy = load < 1 ? mirrored : capacity - mirrored;
+	}
+
+	auto estimate = estimateOf(capacity, arrivalRate, 1 / serviceRate, full, occupancy);
+	estimate.flags = reliability(load, 1.0, 1.0);
+	return estimate;
+}
+
+std::vector<queueing::Estimate> queueing::mg1k(const double arrivalRate, const double serviceMean, const double serviceScv,
+	const std::size_t maxCapacity) {
+	if (arrivalRate <= 0 || serviceMean <= 0 || serviceScv < 0 || maxCapacity == 0) {
+		throw std::invalid_argument("rates, service time and capacity should be positive");
+	}
+
+	const auto load = arrivalRate * serviceMean;
+	const auto flags = reliability(load, 1.0, serviceScv);
+
+	double none;
+	const auto tails = arrivalTails(arrivalRate, serviceMean, serviceScv, maxCapacity, none);
+
+	// the departure-epoch chain does not depend on the capacity except through normalization, so one pass of the
+	// level-crossing recursion answers every capacity up to the largest
+	std::vector<double> departures(maxCapacity);
+	departures[0] = 1;
+	auto sum = 1.0;
+	auto weighted = 0.0;
+
+	std::vector<Estimate> estimates;
+	estimates.reserve(maxCapacity);
+	for (std::size_t capacity = 1; capacity <= maxCapacity; capacity++) {
+		const auto scale = departures[0] + load * sum;
+		const auto full = std::max(0.0, 1 - sum / scale);
+
+		estimates.push_back(estimateOf(capacity, arrivalRate, serviceMean, full, weighted / scale + capacity * full));
+		estimates.back().flags = flags;
+
+		if (capacity == maxCapacity) {
+			break;
+		}
+
+		auto next = departures[0] * tails[capacity - 1];
+		for (std::size_t i = 1; i < capacity; i++) {
+			next += departures[i] * tails[capacity - i];
+		}
+		next /= none;
+
+		departures[capacity] = next;
+		sum += next;
+		weighted += capacity * next;
+
+		if (next > rescaleAbove) {
+			for (std::size_t i = 0; i <= capacity; i++) {
+				departures[i] /= next;
+			}
+			sum /= next;
+			weighted /= next;
+		}
+	}
+
+	return estimates;
+}
+
+std::uint32_t queueing::reliability(const double utilization, const double arrivalScv, const double serviceScv) {
+	std::uint32_t flags = Reliable;
+
+	// close to saturation the answer swings with small errors in the offered rate
+	if (utilization > 0.85 && utilization < 1.2) {
+		flags |= NearSaturation;
+	}
+
+	// a gamma fit of a heavy-tailed service time misses the tail that drives drops
+	if (serviceScv > 2) {
+		flags |= HighVariability;
+	}
+
+	if (std::abs(arrivalScv - 1) > 0.5) {
+		flags |= NonPoissonArrivals;
+	}
+
+	return flags;
+}
+
+std::size_t queueing::capacityFor(const std::vector<Estimate>& sweep, const double dropProbability) {
+	for (const auto& estimate : sweep) {
+		if (estimate.dropProbability <= dropProbability) {
+			return estimate.capacity;
+		}
+	}
+
+	return 0;
+}
+
+queueing::LoadModel::LoadModel(const std::shared_ptr<routing::RoutingTable>& routes, const double messageRate,
+	const double arrivalScv)
+	: m_arrivalScv(arrivalScv) {
+	if (!routes || messageRate <= 0 || arrivalScv < 0) {
+		throw std::invalid_argument("routes and a positive message rate are required");
+	}
+
+	const auto& graph = routes->graph();
+	const auto nodeCount = graph.nodeCount();
+	m_rates.assign(graph.linkCount(), 0);
+	m_transit.assign(graph.linkCount(), 0);
+	if (nodeCount < 2) {
+		return;
+	}
+
+	// every ordered pair is equally likely, as in the traffic generator, so a link carries one unit per source whose
+	// path to the destination crosses it
+	std::vector<double> local(graph.linkCount());
+	std::vector<double> sources(nodeCount, 1);
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> order;
+	order.reserve(nodeCount);
+
+	// trees built here are released once used, so the shared table is not left holding all of them
+	for (std::uint32_t destination = 0; destination < nodeCount; destination++) {
+		const auto cached = routes->treeCount();
+		order.clear();
+		for (std::uint32_t node = 0; node < nodeCount; node++) {
+			const auto distance = routes->distance(node, destination);
+			if (node != destination && distance != topology::Graph::none) {
+				order.emplace_back(distance, node);
+			}
+		}
+		std::sort(order.begin(), order.end(), std::greater<std::pair<std::uint32_t, std::uint32_t>>());
+
+		for (const auto& entry : order) {
+			const auto node = entry.second;
+			const auto link = routes->nextLink(node, destination);
+			if (link == topology::Graph::none) {
+				continue;
+			}
+
+			m_rates[link] += sources[node];
+			local[link] += 1;
+			sources[graph.link(link).target] += sources[node];
+		}
+
+		for (const auto& entry : order) {
+			sources[entry.second] = 1;
+		}
+		sources[destination] = 1;
+
+		if (routes->treeCount() > cached) {
+			routes->release(destination);
+		}
+	}
+
+	const auto perPair = messageRate / (static_cast<double>(nodeCount) * (nodeCount - 1));
+	for (std::uint32_t link = 0; link < graph.linkCount(); link++) {
+		m_transit[link] = m_rates[link] > 0 ? 1 - local[link] / m_rates[link] : 0;
+		m_rates[link] *= perPair;
+	}
+}
+
+double queueing::LoadModel::arrivalRate(const std::uint32_t link) const {
+	return m_rates.at(link);
+}
+
+double queueing::LoadModel::transitShare(const std::uint32_t link) const {
+	return m_transit.at(link);
+}
+
+std::vector<queueing::Estimate> queueing::LoadModel::estimate(const std::uint32_t link, const double serviceMean,
+	const double serviceScv, const std::size_t maxCapacity) const {
+	const auto rate = m_rates.at(link);
+	if (rate == 0) {
+		std::vector<Estimate> idle;
+		for (std::size_t capacity = 1; capacity <= maxCapacity; capacity++) {
+			idle.push_back(Estimate{ capacity, 0, 0, 0, 0, 0, 0, Reliable });
+		}
+		return idle;
+	}
+
+	auto estimates = mg1k(rate, serviceMean, serviceScv, maxCapacity);
+	const auto linkFlags = flags(link, serviceMean, serviceScv);
+	for (auto& estimate : estimates) {
+		estimate.flags = linkFlags;
+	}
+
+	return estimates;
+}
+
+std::vector<queueing::Estimate> queueing::LoadModel::estimate(const double serviceMean, const double serviceScv,
+	const std::size_t capacity) const {
+	std::vector<Estimate> estimates;
+	estimates.reserve(m_rates.size());
+	for (std::uint32_t link = 0; link < m_rates.size(); link++) {
+		estimates.push_back(estimate(link, serviceMean, serviceScv, capacity).back());
+	}
+
+	return estimates;
+}
+
+std::uint32_t queueing::LoadModel::flags(const std::uint32_t link, const double serviceMean, const double serviceScv) const {
+	const auto load = m_rates[link] * serviceMean;
+	auto flags = reliability(load, m_arrivalScv, serviceScv);
+
+	// traffic that already crossed a loaded queue is smoother than poisson, so the model overstates loss there
+	if (m_transit[link] > 0.5 && load > 0.5) {
+		flags |= TransitTraffic;
+	}
+
+	return flags;
+}
@@ -0,0 +1,59 @@
+#ifndef _QUEUEING_H_
+#define _QUEUEING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "routing.h"
+
+namespace queueing {
+	// conditions under which the analytic answer should be confirmed by simulation
+	enum Reliability : std::uint32_t {
+		Reliable = 0,
+		NearSaturation = 1,
+		HighVariability = 2,
+		NonPoissonArrivals = 4,
+		TransitTraffic = 8
+	};
+
+	struct Estimate {
+		std::size_t									capacity;
+		double											utilization;
+		double											occupancy;
+		double											dropProbability;
+		double											throughput;
+		double											waitingTime;
+		double											sojournTime;
+		std::uint32_t									flags;
+	};
+
+	Estimate											mm1k(double arrivalRate, double serviceRate, std::size_t capacity);
+	std::vector<Estimate>								mg1k(double arrivalRate, double serviceMean, double serviceScv,
+															std::size_t maxCapacity);
+
+	std::uint32_t										reliability(double utilization, double arrivalScv, double serviceScv);
+	std::size_t											capacityFor(const std::vector<Estimate>& sweep, double dropProbability);
+
+	class LoadModel {
+	public:
+		LoadModel(const std::shared_ptr<routing::RoutingTable>& routes, double messageRate, double arrivalScv = 1.0);
+
+		double											arrivalRate(std::uint32_t link) const;
+		double											transitShare(std::uint32_t link) const;
+
+		std::vector<Estimate>							estimate(std::uint32_t link, double serviceMean, double serviceScv,
+															std::size_t maxCapacity) const;
+		std::vector<Estimate>							estimate(double serviceMean, double serviceScv, std::size_t capacity) const;
+
+	private:
+		const double									m_arrivalScv;
+		std::vector<double>								m_rates;
+		std::vector<double>								m_transit;
+
+		std::uint32_t									flags(std::uint32_t link, double serviceMean, double serviceScv) const;
+	};
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "rng.h"
+
+#include <algorithm>
+
+const std::size_t rng::Xoshiro256::stateSize;
+const std::size_t rng::Xoshiro256x4::lanes;
+const std::size_t rng::Xoshiro256x4::stateSize;
+
+std::uint64_t rng::mix(std::uint64_t value) {
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+rng::SplitMix64::SplitMix64(const std::uint64_t seed)
+	: m_state(seed) {
+}
+
+std::uint64_t rng::SplitMix64::next() {
+	m_state += 0x9e3779b97f4a7c15ULL;
+	return mix(m_state);
+}
+
+rng::Xoshiro256::Xoshiro256(const std::uint64_t seed) {
+	auto seeder = SplitMix64(seed);
+	for (auto& word : m_state) {
+		word = seeder.next();
+	}
+}
+
+rng::Xoshiro256::Xoshiro256(const Xoshiro256& generator) {
+	setState(generator.m_state);
+}
+
+void rng::Xoshiro256::jump() {
+	static const std::uint64_t polynomial[] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+
+	std::uint64_t jumped[stateSize] = { 0, 0, 0, 0 };
+	for (auto word : polynomial) {
+		for (auto bit = 0; bit < 64; bit++) {
+			if (word & (1ULL << bit)) {
+				for (std::size_t i = 0; i < stateSize; i++) {
+					jumped[i] ^= m_state[i];
+				}
+			}
+			(*this)();
+		}
+	}
+
+	setState(jumped);
+}
+
+void rng::Xoshiro256::state(std::uint64_t* out) const {
+	std::copy(m_state, m_state + stateSize, out);
+}
+
+void rng::Xoshiro256::setState(const std::uint64_t* state) {
+	std::copy(state, state + stateSize, m_state);
+}
+
+rng::Xoshiro256x4::Xoshiro256x4(const std::uint64_t seed) {
+	auto generator = Xoshiro256(seed);
+	std::uint64_t lane[Xoshiro256::stateSize];
+
+	for (std::size_t i = 0; i < lanes; i++) {
+		generator.state(lane);
+		m_s0[i] = lane[0];
+		m_s1[i] = lane[1];
+		m_s2[i] = lane[2];
+		m_s3[i] = lane[3];
+		generator.jump();
+	}
+}
+
+rng::Xoshiro256x4::Xoshiro256x4(const Xoshiro256x4& generator) {
+	std::uint64_t copied[stateSize];
+	generator.state(copied);
+	setState(copied);
+}
+
+void rng::Xoshiro256x4::step(std::uint64_t* out) {
+	for (std::size_t i = 0; i < lanes; i++) {
+		out[i] = rotl(m_s0[i] + m_s3[i], 23) + m_s0[i];
+		const std::uint64_t t = m_s1[i] << 17;
+
+		m_s2[i] ^= m_s0[i];
+		m_s3[i] ^= m_s1[i];
+		m_s1[i] ^= m_s2[i];
+		m_s0[i] ^= m_s3[i];
+
+		m_s2[i] ^= t;
+		m_s3[i] = rotl(m_s3[i], 45);
+	}
+}
+
+void rng::Xoshiro256x4::fill(std::uint64_t* out, const std::size_t count) {
+	std::size_t index = 0;
+	for (; index + lanes <= count; index += lanes) {
+		step(out + index);
+	}
+
+	if (index < count) {
+		std::uint64_t tail[lanes];
+		step(tail);
+		std::copy(tail, tail + (count - index), out + index);
+	}
+}
+
+void rng::Xoshiro256x4::fillUnit(double* out, const std::size_t count) {
+	const std::size_t chunk = 256;
+	std::uint64_t raw[chunk];
+
+	for (std::size_t index = 0; index < count; index += chunk) {
+		const auto length = std::min(chunk, count - index);
+		fill(raw, length);
+		for (std::size_t i = 0; i < length; i++) {
+			out[index + i] = toUnit(raw[i]);
+		}
+	}
+}
+
+void rng::Xoshiro256x4::state(std::uint64_t* out) const {
+	std::copy(m_s0, m_s0 + lanes, out);
+	std::copy(m_s1, m_s1 + lanes, out + lanes);
+	std::copy(m_s2, m_s2 + lanes, out + 2 * lanes);
+	std::copy(m_s3, m_s3 + lanes, out + 3 * lanes);
+}
+
+void rng::Xoshiro256x4::setState(const std::uint64_t* state) {
+	std::copy(state, state + lanes, m_s0);
+	std::copy(state + lanes, state + 2 * lanes, m_s1);
+	std::copy(state + 2 * lanes, state + 3 * lanes, m_s2);
+	std::copy(state + 3 * lanes, state + 4 * lanes, m_s3);
+}
@@ -0,0 +1,100 @@
+#ifndef _RNG_H_
+#define _RNG_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rng {
+	std::uint64_t									mix(std::uint64_t value);
+
+	class SplitMix64 {
+	public:
+		explicit SplitMix64(std::uint64_t seed);
+
+		std::uint64_t								next();
+
+	private:
+		std::uint64_t								m_state;
+	};
+
+	class Xoshiro256 {
+	public:
+		typedef std::uint64_t						result_type;
+
+		static const std::size_t					stateSize = 4;
+
+		explicit Xoshiro256(std::uint64_t seed = 0);
+		Xoshiro256(const Xoshiro256&);
+
+		static constexpr result_type				min() { return 0; }
+		static constexpr result_type				max() { return UINT64_MAX; }
+
+		result_type									operator()();
+		double										nextUnit();
+
+		void										jump();
+
+		void										state(std::uint64_t* out) const;
+		void										setState(const std::uint64_t* state);
+
+	private:
+		std::uint64_t								m_state[stateSize];
+	};
+
+	class Xoshiro256x4 {
+	public:
+		static const std::size_t					lanes = 4;
+		static const std::size_t					stateSize = Xoshiro256::stateSize * lanes;
+
+		explicit Xoshiro256x4(std::uint64_t seed = 0);
+		Xoshiro256x4(const Xoshiro256x4&);
+
+		void										fill(std::uint64_t* out, std::size_t count);
+		void										fillUnit(double* out, std::size_t count);
+
+		void										state(std::uint64_t* out) const;
+		void										setState(const std::uint64_t* state);
+
+	private:
+		alignas(32) std::uint64_t					m_s0[lanes];
+		alignas(32) std::uint64_t					m_s1[lanes];
+		alignas(32) std::uint64_t					m_s2[lanes];
+		alignas(32) std::uint64_t					m_s3[lanes];
+
+		void										step(std::uint64_t* out);
+	};
+
+	inline std::uint64_t rotl(const std::uint64_t value, const int shift) {
+		return (value << shift) | (value >> (64 - shift));
+	}
+
+	inline double toUnit(const std::uint64_t value) {
+		// (0, 1]: never zero, so the result is safe to feed into log() and pow(u, -1/a)
+		return ((value >> 11) + 1) * (1.0 / 9007199254740992.0);
+	}
+
+	inline std::uint32_t toIndex(const std::uint64_t value, const std::uint32_t bound) {
+		return static_cast<std::uint32_t>(((value >> 32) * bound) >> 32);
+	}
+
+	inline Xoshiro256::result_type Xoshiro256::operator()() {
+		const std::uint64_t result = rotl(m_state[0] + m_state[3], 23) + m_state[0];
+		const std::uint64_t t = m_state[1] << 17;
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+
+		m_state[2] ^= t;
+		m_state[3] = rotl(m_state[3], 45);
+
+		return result;
+	}
+
+	inline double Xoshiro256::nextUnit() {
+		return toUnit((*this)());
+	}
+}
+
+#endif
@@ -0,0 +1,332 @@
+#include "routing.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+routing::RoutingTable::RoutingTable(const std::shared_ptr<const topology::Graph>& graph)
+	: m_graph(graph), m_treeCount(0), m_version(0), m_rewritten(0) {
+	if (!graph) {
+		throw std::invalid_argument("graph should be set");
+	}
+
+	m_trees.resize(graph->nodeCount());
+	m_linkUp.assign(graph->linkCount(), 1);
+	m_nodeUp.assign(graph->nodeCount(), 1);
+	m_affected.assign(graph->nodeCount(), 0);
+}
+
+const topology::Graph& routing::RoutingTable::graph() const {
+	return *m_graph;
+}
+
+std::uint32_t routing::RoutingTable::nextLink(const std::uint32_t node, const std::uint32_t destination) {
+	return tree(destination).next[node];
+}
+
+std::uint32_t routing::RoutingTable::distance(const std::uint32_t node, const std::uint32_t destination) {
+	return tree(destination).distance[node];
+}
+
+std::size_t routing::RoutingTable::treeCount() const {
+	return m_treeCount;
+}
+
+void routing::RoutingTable::clear() {
+	for (auto& tree : m_trees) {
+		tree.reset();
+	}
+	m_treeCount = 0;
+}
+
+void routing::RoutingTable::release(const std::uint32_t destination) {
+	if (destination >= m_trees.size()) {
+		throw std::out_of_range("destination should be a node of the graph");
+	}
+
+	auto& tree = m_trees[destination];
+	if (tree) {
+		tree.reset();
+		m_treeCount--;
+	}
+}
+
+bool routing::RoutingTable::isLinkUp(const std::uint32_t link) const {
+	return m_linkUp.at(link) != 0;
+}
+
+bool routing::RoutingTable::isNodeUp(const std::uint32_t node) const {
+	return m_nodeUp.at(node) != 0;
+}
+
+bool routing::RoutingTable::isUsable(const std::uint32_t link) const {
+	const auto& ends = m_graph->link(link);
+	return m_linkUp[link] && m_nodeUp[ends.source] && m_nodeUp[ends.target];
+}
+
+std::uint64_t routing::RoutingTable::version() const {
+	return m_version;
+}
+
+std::uint64_t routing::RoutingTable::rewritten() const {
+	return m_rewritten;
+}
+
+void routing::RoutingTable::setLinkUp(const std::uint32_t link, const bool up) {
+	setLinksUp(std::vector<std::uint32_t>(1, link), up);
+}
+
+void routing::RoutingTable::setNodeUp(const std::uint32_t node, const bool up) {
+	setNodesUp(std::vector<std::uint32_t>(1, node), up);
+}
+
+void routing::RoutingTable::setLinksUp(const std::vector<std::uint32_t>& links, const bool up) {
+	std::vector<std::uint32_t> changed;
+	for (auto link : links) {
+		if (link >= m_linkUp.size()) {
+			throw std::out_of_range("link should belong to the graph");
+		}
+
+		if ((m_linkUp[link] != 0) == up) {
+			continue;
+		}
+
+		// only links whose endpoints are up change what routes can use
+		if (!up && isUsable(link)) {
+			changed.push_back(link);
+		}
+		m_linkUp[link] = up;
+		m_version++;
+		if (up && isUsable(link)) {
+			changed.push_back(link);
+		}
+	}
+
+	repair(changed, up);
+}
+
+void routing::RoutingTable::setNodesUp(const std::vector<std::uint32_t>& nodes, const bool up) {
+	const auto& graph = *m_graph;
+	std::vector<std::uint32_t> changed;
+
+	const auto collect = [&](const std::uint32_t node) {
+		for (auto link = graph.outBegin(node); link < graph.outEnd(node); link++) {
+			if (isUsable(link)) {
+				changed.push_back(link);
+			}
+		}
+		for (auto position = graph.inBegin(node); position < graph.inEnd(node); position++) {
+			if (isUsable(graph.inLink(position))) {
+				changed.push_back(graph.inLink(position));
+			}
+		}
+	};
+
+	for (auto node : nodes) {
+		if (node >= m_nodeUp.size()) {
+			throw std::out_of_range("node should belong to the graph");
+		}
+
+		if ((m_nodeUp[node] != 0) == up) {
+			continue;
+		}
+
+		if (!up) {
+			collect(node);
+		}
+		m_nodeUp[node] = up;
+		m_version++;
+		if (up) {
+			collect(node);
+		}
+
+		// routes towards the node itself are rebuilt on next use
+		if (m_trees[node]) {
+			m_trees[node].reset();
+			m_treeCount--;
+		}
+	}
+
+	repair(changed, up);
+}
+
+const routing::RoutingTable::Tree& routing::RoutingTable::tree(const std::uint32_t destination) {
+	if (destination >= m_trees.size()) {
+		throw std::out_of_range("destination should be a node of the graph");
+	}
+
+	// trees are built per destination on first use, a full table would be quadratic in nodes
+	auto& tree = m_trees[destination];
+	if (!tree) {
+		tree.reset(new Tree());
+		build(destination, *tree);
+		m_treeCount++;
+	}
+
+	return *tree;
+}
+
+void routing::RoutingTable::build(const std::uint32_t destination, Tree& tree) const {
+	const auto& graph = *m_graph;
+	tree.next.assign(graph.nodeCount(), topology::Graph::none);
+	tree.distance.assign(graph.nodeCount(), topology::Graph::none);
+
+	if (!m_nodeUp[destination]) {
+		return;
+	}
+
+	// breadth-first over incoming links, the link a node is discovered through is its next hop
+	std::vector<std::uint32_t> frontier;
+	frontier.reserve(graph.nodeCount());
+	frontier.push_back(destination);
+	tree.distance[destination] = 0;
+
+	for (std::size_t head = 0; head < frontier.size(); head++) {
+		const auto node = frontier[head];
+		for (auto position = graph.inBegin(node); position < graph.inEnd(node); position++) {
+			const auto link = graph.inLink(position);
+			const auto source = graph.link(link).source;
+			if (tree.distance[source] == topology::Graph::none && isUsable(link)) {
+				tree.distance[source] = tree.distance[node] + 1;
+				tree.next[source] = link;
+				frontier.push_back(source);
+			}
+		}
+	}
+}
+
+void routing::RoutingTable::repair(const std::vector<std::uint32_t>& links, const bool up) {
+	if (links.empty()) {
+		return;
+	}
+
+	for (auto& tree : m_trees) {
+		if (!tree) {
+			continue;
+		}
+
+		if (up) {
+			insert(*tree, links);
+		}
+		else {
+			remove(*tree, links);
+		}
+	}
+}
+
+void routing::RoutingTable::remove(Tree& tree, const std::vector<std::uint32_t>& links) {
+	const auto& graph = *m_graph;
+	const auto none = topology::Graph::none;
+
+	// only nodes whose path ran over a removed link lose their route, together with everything routed through them
+	m_nodes.clear();
+	for (auto link : links) {
+		const auto source = graph.link(link).source;
+		if (tree.next[source] == link && !m_affected[source]) {
+			m_affected[source] = 1;
+			m_nodes.push_back(source);
+		}
+	}
+
+	if (m_nodes.empty()) {
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_nodes.size(); i++) {
+		const auto node = m_nodes[i];
+		for (auto position = graph.inBegin(node); position < graph.inEnd(node); position++) {
+			const auto link = graph.inLink(position);
+			const auto child = graph.link(link).source;
+			if (tree.next[child] == link && !m_affected[child]) {
+				m_affected[child] = 1;
+				m_nodes.push_back(child);
+			}
+		}
+	}
+
+	for (auto node : m_nodes) {
+		tree.distance[node] = none;
+		tree.next[node] = none;
+	}
+	m_rewritten += m_nodes.size();
+
+	// reattach each affected node to its best neighbour outside the affected subtree, then settle the rest
+	m_heap.clear();
+	for (auto node : m_nodes) {
+		if (!m_nodeUp[node]) {
+			continue;
+		}
+
+		for (auto link = graph.outBegin(node); link < graph.outEnd(node); link++) {
+			const auto target = graph.link(link).target;
+			if (m_affected[target] || tree.distance[target] == none || !isUsable(link)) {
+				continue;
+			}
+
+			if (tree.distance[target] + 1 < tree.distance[node]) {
+				tree.distance[node] = tree.distance[target] + 1;
+				tree.next[node] = link;
+			}
+		}
+
+		if (tree.distance[node] != none) {
+			m_heap.emplace_back(tree.distance[node], node);
+			std::push_heap(m_heap.begin(), m_heap.end(), std::greater<std::pair<std::uint32_t, std::uint32_t>>());
+		}
+	}
+
+	for (auto node : m_nodes) {
+		m_affected[node] = 0;
+	}
+
+	settle(tree);
+}
+
+void routing::RoutingTable::insert(Tree& tree, const std::vector<std::uint32_t>& links) {
+	const auto& graph = *m_graph;
+	const auto none = topology::Graph::none;
+
+	m_heap.clear();
+	for (auto link : links) {
+		const auto& ends = graph.link(link);
+		if (tree.distance[ends.target] == none || tree.distance[ends.target] + 1 >= tree.distance[ends.source]) {
+			continue;
+		}
+
+		tree.distance[ends.source] = tree.distance[ends.target] + 1;
+		tree.next[ends.source] = link;
+		m_rewritten++;
+		m_heap.emplace_back(tree.distance[ends.source], ends.source);
+		std::push_heap(m_heap.begin(), m_heap.end(), std::greater<std::pair<std::uint32_t, std::uint32_t>>());
+	}
+
+	settle(tree);
+}
+
+void routing::RoutingTable::settle(Tree& tree) {
+	const auto& graph = *m_graph;
+	const auto order = std::greater<std::pair<std::uint32_t, std::uint32_t>>();
+
+	while (!m_heap.empty()) {
+		std::pop_heap(m_heap.begin(), m_heap.end(), order);
+		const auto entry = m_heap.back();
+		m_heap.pop_back();
+
+		const auto node = entry.second;
+		if (entry.first != tree.distance[node]) {
+			continue;
+		}
+
+		for (auto position = graph.inBegin(node); position < graph.inEnd(node); position++) {
+			const auto link = graph.inLink(position);
+			const auto source = graph.link(link).source;
+			if (entry.first + 1 < tree.distance[source] && isUsable(link)) {
+				tree.distance[source] = entry.first + 1;
+				tree.next[source] = link;
+				m_rewritten++;
+				m_heap.emplace_back(entry.first + 1, source);
+				std::push_heap(m_heap.begin(), m_heap.end(), order);
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef _ROUTING_H_
+#define _ROUTING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "topology.h"
+
+namespace routing {
+	class RoutingTable {
+	public:
+		explicit RoutingTable(const std::shared_ptr<const topology::Graph>& graph);
+
+		const topology::Graph&						graph() const;
+
+		std::uint32_t								nextLink(std::uint32_t node, std::uint32_t destination);
+		std::uint32_t								distance(std::uint32_t node, std::uint32_t destination);
+
+		std::size_t									treeCount() const;
+		void										clear();
+		void										release(std::uint32_t destination);
+
+		bool										isLinkUp(std::uint32_t link) const;
+		bool										isNodeUp(std::uint32_t node) const;
+		bool										isUsable(std::uint32_t link) const;
+		std::uint64_t								version() const;
+		std::uint64_t								rewritten() const;
+
+		void										setLinkUp(std::uint32_t link, bool up);
+		void										setNodeUp(std::uint32_t node, bool up);
+		void										setLinksUp(const std::vector<std::uint32_t>& links, bool up);
+		void										setNodesUp(const std::vector<std::uint32_t>& nodes, bool up);
+
+	private:
+		struct Tree {
+			std::vector<std::uint32_t>				next;
+			std::vector<std::uint32_t>				distance;
+		};
+
+		std::shared_ptr<const topology::Graph>		m_graph;
+		std::vector<std::unique_ptr<Tree>>			m_trees;
+		std::size_t									m_treeCount;
+		std::vector<char>							m_linkUp;
+		std::vector<char>							m_nodeUp;
+		std::uint64_t								m_version;
+		std::uint64_t								m_rewritten;
+
+		std::vector<char>							m_affected;
+		std::vector<std::uint32_t>					m_nodes;
+		std::vector<std::pair<std::uint32_t, std::uint32_t>>	m_heap;
+
+		const Tree&									tree(std::uint32_t destination);
+		void										build(std::uint32_t destination, Tree& tree) const;
+
+		void										repair(const std::vector<std::uint32_t>& links, bool up);
+		void										remove(Tree& tree, const std::vector<std::uint32_t>& links);
+		void										insert(Tree& tree, const std::vector<std::uint32_t>& links);
+		void										settle(Tree& tree);
+	};
+}
+
+#endif
@@ -0,0 +1,584 @@
+#include "sharding.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "routing.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const std::size_t			cacheLine = 64;
+	const unsigned				spinsBeforeYield = 256;
+
+	struct Packet {
+		std::uint64_t			step;
+		double					sentAt;
+		std::uint32_t			destination;
+		std::uint32_t			link;
+	};
+
+	struct Barrier {
+		alignas(64) std::atomic<std::uint32_t>	count;
+		alignas(64) std::atomic<std::uint32_t>	generation;
+		alignas(64) std::atomic<std::uint32_t>	abort;
+	};
+
+	struct Counters {
+		alignas(64) std::uint64_t				finished[2];
+		std::uint64_t							delivered;
+		std::uint64_t							forwarded;
+		std::uint64_t							dropped;
+		std::uint64_t							unroutable;
+		std::uint64_t							steps;
+	};
+
+	// single producer single consumer, positions only grow so full and empty never look alike
+	struct Ring {
+		alignas(64) std::atomic<std::uint64_t>	head;
+		alignas(64) std::atomic<std::uint64_t>	tail;
+		alignas(64) std::uint64_t				capacity;
+		std::uint64_t							offset;
+	};
+
+	static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "shared memory atomics should be lock free");
+
+	// what a shard sees of the shared state, in a single process the counters and results are plain local memory
+	struct View {
+		Barrier*								barrier;
+		Counters*								counters;
+		Ring*									rings;
+		unsigned char*							base;
+		std::uint64_t*							received;
+		double*									latency;
+	};
+
+	std::size_t aligned(const std::size_t offset) {
+		return (offset + cacheLine - 1) & ~(cacheLine - 1);
+	}
+
+	void pause(unsigned& spins, const Barrier* barrier) {
+		if (barrier->abort.load(std::memory_order_relaxed)) {
+			throw std::runtime_error("another shard failed");
+		}
+
+		if (++spins >= spinsBeforeYield) {
+			spins = 0;
+			std::this_thread::yield();
+		}
+	}
+
+	void wait(Barrier* barrier, const std::uint32_t parties) {
+		const auto generation = barrier->generation.load(std::memory_order_acquire);
+		if (barrier->count.fetch_add(1, std::memory_order_acq_rel) + 1 == parties) {
+			barrier->count.store(0, std::memory_order_relaxed);
+			barrier->generation.fetch_add(1, std::memory_order_release);
+			return;
+		}
+
+		unsigned spins = 0;
+		while (barrier->generation.load(std::memory_order_acquire) == generation) {
+			pause(spins, barrier);
+		}
+	}
+
+	class Shard {
+	public:
+		Shard(const std::shared_ptr<const topology::Graph>& graph, const std::vector<traffic::Arrival>& arrivals,
+			const sharding::Options& options, const std::vector<std::uint32_t>& bounds, unsigned index, const View& view);
+
+		void									run(std::size_t maxSteps);
+
+	private:
+		struct Queue {
+			std::vector<Packet>					packets;
+			std::size_t							head;
+		};
+
+		const topology::Graph&					m_graph;
+		const std::vector<traffic::Arrival>&	m_arrivals;
+		const sharding::Options&				m_options;
+		const std::vector<std::uint32_t>&		m_bounds;
+		const unsigned							m_index;
+		const View								m_view;
+
+		routing::RoutingTable					m_routes;
+		std::vector<std::vector<std::uint32_t>>	m_next;
+		const std::uint32_t						m_firstLink;
+		std::vector<Queue>						m_queues;
+		std::vector<std::uint32_t>				m_active;
+		std::vector<Packet>						m_landed;
+
+		std::uint64_t							m_finished;
+		std::uint64_t							m_delivered;
+		std::uint64_t							m_forwarded;
+		std::uint64_t							m_dropped;
+		std::uint64_t							m_unroutable;
+
+		bool									isLocal(std::uint32_t node) const;
+		unsigned								ownerOf(std::uint32_t node) const;
+		std::uint32_t							nextLink(std::uint32_t node, std::uint32_t destination);
+
+		void									transmit(std::uint64_t step);
+		void									route(std::uint32_t node, const Packet& packet);
+		void									deliver(std::uint32_t node, const Packet& packet, double time);
+
+		void									push(unsigned target, const Packet& packet);
+		void									drain(unsigned source, std::uint64_t step);
+	};
+
+	Shard::Shard(const std::shared_ptr<const topology::Graph>& graph, const std::vector<traffic::Arrival>& arrivals,
+		const sharding::Options& options, const std::vector<std::uint32_t>& bounds, const unsigned index, const View& view)
+		: m_graph(*graph), m_arrivals(arrivals), m_options(options), m_bounds(bounds), m_index(index), m_view(view),
+		m_routes(graph), m_firstLink(graph->outBegin(bounds[index])), m_finished(0), m_delivered(0), m_forwarded(0),
+		m_dropped(0), m_unroutable(0) {
+		// nodes are contiguous per shard and links are sorted by source, so a shard owns one range of link queues
+		m_queues.resize(graph->outBegin(bounds[index + 1]) - m_firstLink, Queue{ std::vector<Packet>(), 0 });
+		m_next.resize(graph->nodeCount());
+	}
+
+	void Shard::run(const std::size_t maxSteps) {
+		const auto shards = static_cast<unsigned>(m_bounds.size() - 1);
+		const auto first = m_bounds[m_index];
+		const auto last = m_bounds[m_index + 1];
+		auto& counters = m_view.counters[m_index];
+
+		std::size_t next = 0;
+		std::uint64_t step = 0;
+		auto time = 0.0;
+		auto isDone = false;
+
+		do {
+			// packets sent in the previous step land first, a faster neighbour may already have queued newer ones
+			if (m_view.rings) {
+				for (unsigned source = 0; source < shards; source++) {
+					if (source != m_index) {
+						drain(source, step);
+					}
+				}
+			}
+
+			// every node sees its arrivals ordered by link whatever the partition, which keeps runs identical
+			std::stable_sort(m_landed.begin(), m_landed.end(),
+				[](const Packet& left, const Packet& right) { return left.link < right.link; });
+			for (const auto& packet : m_landed) {
+				const auto node = m_graph.link(packet.link).target;
+				if (node == packet.destination) {
+					deliver(node, packet, time);
+				}
+				else {
+					route(node, packet);
+				}
+			}
+			m_landed.clear();
+
+			for (; next < m_arrivals.size() && m_arrivals[next].time < time + m_options.stepDuration; next++) {
+				const auto& arrival = m_arrivals[next];
+				if (arrival.source < first || arrival.source >= last) {
+					continue;
+				}
+
+				const auto packet = Packet{ 0, arrival.time, arrival.destination, topology::Graph::none };
+				if (arrival.source == arrival.destination) {
+					// the step started before the arrival, which is received the moment it is sent
+					deliver(arrival.source, packet, std::max(time, arrival.time));
+				}
+				else {
+					route(arrival.source, packet);
+				}
+			}
+
+			transmit(step);
+			time += m_options.stepDuration;
+			step++;
+
+			if (!m_view.barrier) {
+				isDone = m_finished == m_arrivals.size();
+				continue;
+			}
+
+			// totals alternate between two slots so nobody overwrites a value another shard is still reading
+			counters.finished[step % 2] = m_finished;
+			wait(m_view.barrier, shards);
+
+			std::uint64_t finished = 0;
+			for (unsigned shard = 0; shard < shards; shard++) {
+				finished += m_view.counters[shard].finished[step % 2];
+			}
+			isDone = finished == m_arrivals.size();
+		} while (step < maxSteps && !isDone);
+
+		counters.delivered = m_delivered;
+		counters.forwarded = m_forwarded;
+		counters.dropped = m_dropped;
+		counters.unroutable = m_unroutable;
+		counters.steps = step;
+	}
+
+	bool Shard::isLocal(const std::uint32_t node) const {
+		return node >= m_bounds[m_index] && node < m_bounds[m_index + 1];
+	}
+
+	unsigned Shard::ownerOf(const std::uint32_t node) const {
+		return static_cast<unsigned>(std::upper_bound(m_bounds.begin(), m_bounds.end(), node) - m_bounds.begin() - 1);
+	}
+
+	std::uint32_t Shard::nextLink(const std::uint32_t node, const std::uint32_t destination) {
+		const auto first = m_bounds[m_index];
+		auto& next = m_next[destination];
+
+		// only the owned nodes' hops are kept, the full tree is dropped once they are copied out
+		if (next.empty()) {
+			next.resize(m_bounds[m_index + 1] - first);
+			for (std::uint32_t i = 0; i < next.size(); i++) {
+				next[i] = m_routes.nextLink(first + i, destination);
+			}
+			m_routes.release(destination);
+		}
+
+		return next[node - first];
+	}
+
+	void Shard::transmit(const std::uint64_t step) {
+		std::sort(m_active.begin(), m_active.end());
+		std::size_t active = 0;
+
+		for (auto link : m_active) {
+			auto& queue = m_queues[link - m_firstLink];
+			const auto count = std::min(m_options.linkCapacity, queue.packets.size() - queue.head);
+			const auto target = m_graph.link(link).target;
+			const auto isRemote = !isLocal(target);
+			const auto owner = isRemote ? ownerOf(target) : m_index;
+
+			for (std::size_t i = 0; i < count; i++) {
+				auto packet = queue.packets[queue.head++];
+				packet.link = link;
+				packet.step = step;
+				if (isRemote) {
+					push(owner, packet);
+				}
+				else {
+					m_landed.push_back(packet);
+				}
+			}
+			m_forwarded += count;
+
+			if (queue.head == queue.packets.size()) {
+				queue.packets.clear();
+				queue.head = 0;
+				continue;
+			}
+
+			if (queue.head * 2 > queue.packets.size()) {
+				queue.packets.erase(queue.packets.begin(), queue.packets.begin() + queue.head);
+				queue.head = 0;
+			}
+			m_active[active++] = link;
+		}
+
+		m_active.resize(active);
+	}
+
+	void Shard::route(const std::uint32_t node, const Packet& packet) {
+		const auto link = nextLink(node, packet.destination);
+		if (link == topology::Graph::none) {
+			m_unroutable++;
+			m_finished++;
+			return;
+		}
+
+		auto& queue = m_queues[link - m_firstLink];
+		const auto length = queue.packets.size() - queue.head;
+		if (length >= m_options.queueCapacity) {
+			m_dropped++;
+			m_finished++;
+			return;
+		}
+
+		if (length == 0) {
+			m_active.push_back(link);
+		}
+		queue.packets.push_back(packet);
+	}
+
+	void Shard::deliver(const std::uint32_t node, const Packet& packet, const double time) {
+		m_view.received[node]++;
+		m_view.latency[node] += time - packet.sentAt;
+		m_delivered++;
+		m_finished++;
+	}
+
+	void Shard::push(const unsigned target, const Packet& packet) {
+		const auto shards = m_bounds.size() - 1;
+		auto& ring = m_view.rings[m_index * shards + target];
+		auto slots = reinterpret_cast<Packet*>(m_view.base + ring.offset);
+		const auto tail = ring.tail.load(std::memory_order_relaxed);
+
+		// rings hold two steps of the busiest case, so this only spins if the consumer is descheduled
+		unsigned spins = 0;
+		while (tail - ring.head.load(std::memory_order_acquire) >= ring.capacity) {
+			pause(spins, m_view.barrier);
+		}
+
+		slots[tail % ring.capacity] = packet;
+		ring.tail.store(tail + 1, std::memory_order_release);
+	}
+
+	void Shard::drain(const unsigned source, const std::uint64_t step) {
+		const auto shards = m_bounds.size() - 1;
+		auto& ring = m_view.rings[source * shards + m_index];
+		const auto slots = reinterpret_cast<const Packet*>(m_view.base + ring.offset);
+		const auto tail = ring.tail.load(std::memory_order_acquire);
+		auto head = ring.head.load(std::memory_order_relaxed);
+
+		while (head < tail && slots[head % ring.capacity].step < step) {
+			m_landed.push_back(slots[head % ring.capacity]);
+			head++;
+		}
+
+		ring.head.store(head, std::memory_order_release);
+	}
+
+#if defined(__linux__)
+	void pin(const unsigned shard) {
+		const auto nodes = sharding::ShardedSimulation::numaNodes();
+		if (nodes.empty()) {
+			return;
+		}
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (auto cpu : nodes[shard % nodes.size()]) {
+			CPU_SET(cpu, &cpus);
+		}
+
+		// pinning is best effort, a restricted cpuset keeps the scheduler's choice
+		sched_setaffinity(0, sizeof(cpus), &cpus);
+	}
+#endif
+}
+
+sharding::Options::Options()
+	: shards(1), stepDuration(1.0), linkCapacity(1), queueCapacity(std::numeric_limits<std::size_t>::max()),
+	pinToNuma(true) {
+}
+
+sharding::ShardedSimulation::ShardedSimulation(const std::shared_ptr<const topology::Graph>& graph,
+	const std::vector<traffic::Arrival>& arrivals, const Options& options)
+	: m_graph(graph), m_arrivals(arrivals), m_options(options) {
+	if (!graph || graph->nodeCount() == 0) {
+		throw std::invalid_argument("graph should have nodes");
+	}
+
+	if (options.shards == 0 || options.stepDuration <= 0 || options.linkCapacity == 0 || options.queueCapacity == 0) {
+		throw std::invalid_argument("shards, step duration and capacities should be positive");
+	}
+
+	for (std::size_t i = 0; i < arrivals.size(); i++) {
+		if (arrivals[i].source >= graph->nodeCount() || arrivals[i].destination >= graph->nodeCount()) {
+			throw std::invalid_argument("arrivals should stay within the graph");
+		}
+
+		if (i > 0 && arrivals[i].time < arrivals[i - 1].time) {
+			throw std::invalid_argument("arrivals should be ordered by time");
+		}
+	}
+
+	// contiguous blocks keep every shard's link queues in one range of the graph's link order
+	m_options.shards = std::min(options.shards, graph->nodeCount());
+	for (unsigned shard = 0; shard <= m_options.shards; shard++) {
+		m_bounds.push_back(static_cast<std::uint32_t>(static_cast<std::uint64_t>(graph->nodeCount()) * shard / m_options.shards));
+	}
+}
+
+sharding::Result sharding::ShardedSimulation::run(const std::size_t maxSteps) const {
+	const auto nodeCount = m_graph->nodeCount();
+	const auto shards = m_options.shards;
+	auto result = Result{ 0, 0, 0, 0, 0, std::vector<std::uint64_t>(nodeCount), std::vector<double>(nodeCount) };
+
+	if (shards == 1) {
+		Counters counters{};
+		const auto view = View{ nullptr, &counters, nullptr, nullptr, result.received.data(), result.latency.data() };
+		Shard(m_graph, m_arrivals, m_options, m_bounds, 0, view).run(maxSteps);
+
+		result.steps = counters.steps;
+		result.delivered = counters.delivered;
+		result.forwarded = counters.forwarded;
+		result.dropped = counters.dropped;
+		result.unroutable = counters.unroutable;
+		return result;
+	}
+
+#if defined(__linux__)
+	// each ring holds two steps of traffic over the links it carries, enough as a producer is at most one step ahead
+	std::vector<std::uint64_t> capacities(shards * shards, 1);
+	for (std::uint32_t link = 0; link < m_graph->linkCount(); link++) {
+		const auto source = shardOf(m_graph->link(link).source);
+		const auto target = shardOf(m_graph->link(link).target);
+		if (source != target) {
+			capacities[source * shards + target] += 2 * m_options.linkCapacity;
+		}
+	}
+
+	const auto countersOffset = aligned(sizeof(Barrier));
+	const auto ringsOffset = aligned(countersOffset + shards * sizeof(Counters));
+	auto offset = aligned(ringsOffset + shards * shards * sizeof(Ring));
+	std::vector<std::size_t> slotOffsets;
+	for (auto capacity : capacities) {
+		slotOffsets.push_back(offset);
+		offset = aligned(offset + capacity * sizeof(Packet));
+	}
+	const auto receivedOffset = offset;
+	const auto latencyOffset = aligned(receivedOffset + nodeCount * sizeof(std::uint64_t));
+	const auto size = aligned(latencyOffset + nodeCount * sizeof(double));
+
+	// the name is dropped as soon as the region is mapped, children inherit the mapping and nothing is left behind
+	static std::atomic<unsigned> runs(0);
+	const auto name = "networkcpp-shards-" + std::to_string(getpid()) + "-" + std::to_string(runs++);
+	boost::interprocess::shared_memory_object memory(boost::interprocess::create_only, name.c_str(),
+		boost::interprocess::read_write);
+	memory.truncate(static_cast<boost::interprocess::offset_t>(size));
+	boost::interprocess::mapped_region region(memory, boost::interprocess::read_write);
+	boost::interprocess::shared_memory_object::remove(name.c_str());
+
+	auto base = static_cast<unsigned char*>(region.get_address());
+	std::memset(base, 0, size);
+	auto barrier = new (base) Barrier();
+	auto counters = new (base + countersOffset) Counters[shards]();
+	auto rings = new (base + ringsOffset) Ring[shards * shards]();
+	for (std::size_t ring = 0; ring < capacities.size(); ring++) {
+		rings[ring].capacity = capacities[ring];
+		rings[ring].offset = slotOffsets[ring];
+	}
+
+	const auto view = View{ barrier, counters, rings, base, reinterpret_cast<std::uint64_t*>(base + receivedOffset),
+		reinterpret_cast<double*>(base + latencyOffset) };
+
+	std::vector<pid_t> children;
+	for (unsigned shard = 0; shard < shards; shard++) {
+		const auto child = fork();
+		if (child == 0) {
+			try {
+				if (m_options.pinToNuma) {
+					pin(shard);
+				}
+				Shard(m_graph, m_arrivals, m_options, m_bounds, shard, view).run(maxSteps);
+				_exit(0);
+			}
+			catch (...) {
+				barrier->abort.store(1);
+				_exit(1);
+			}
+		}
+
+		if (child < 0) {
+			barrier->abort.store(1);
+			break;
+		}
+		children.push_back(child);
+	}
+
+	// a failed shard raises the abort flag so the others leave the barrier instead of waiting forever
+	auto isFailed = children.size() != shards;
+	while (!children.empty()) {
+		for (auto child = children.begin(); child != children.end();) {
+			int status = 0;
+			if (waitpid(*child, &status, WNOHANG) == 0) {
+				++child;
+				continue;
+			}
+
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				barrier->abort.store(1);
+				isFailed = true;
+			}
+			child = children.erase(child);
+		}
+
+		if (!children.empty()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	if (isFailed) {
+		throw std::runtime_error("shard process failed");
+	}
+
+	result.steps = counters[0].steps;
+	for (unsigned shard = 0; shard < shards; shard++) {
+		result.delivered += counters[shard].delivered;
+		result.forwarded += counters[shard].forwarded;
+		result.dropped += counters[shard].dropped;
+		result.unroutable += counters[shard].unroutable;
+	}
+	std::copy(view.received, view.received + nodeCount, result.received.begin());
+	std::copy(view.latency, view.latency + nodeCount, result.latency.begin());
+
+	return result;
+#else
+	throw std::runtime_error("multi-process sharding needs Linux");
+#endif
+}
+
+unsigned sharding::ShardedSimulation::shardCount() const {
+	return m_options.shards;
+}
+
+unsigned sharding::ShardedSimulation::shardOf(const std::uint32_t node) const {
+	if (node >= m_graph->nodeCount()) {
+		throw std::out_of_range("node is not part of the graph");
+	}
+
+	return static_cast<unsigned>(std::upper_bound(m_bounds.begin(), m_bounds.end(), node) - m_bounds.begin() - 1);
+}
+
+std::uint32_t sharding::ShardedSimulation::crossLinks() const {
+	std::uint32_t count = 0;
+	for (std::uint32_t link = 0; link < m_graph->linkCount(); link++) {
+		if (shardOf(m_graph->link(link).source) != shardOf(m_graph->link(link).target)) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+std::vector<std::vector<int>> sharding::ShardedSimulation::numaNodes() {
+	std::vector<std::vector<int>> nodes;
+
+	// cpulist reads like 0-3,8-11
+	for (auto node = 0;; node++) {
+		std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+		if (!file) {
+			break;
+		}
+
+		std::vector<int> cpus;
+		std::string range;
+		while (std::getline(file, range, ',')) {
+			const auto dash = range.find('-');
+			const auto first = std::stoi(range.substr(0, dash));
+			const auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+			for (auto cpu = first; cpu <= last; cpu++) {
+				cpus.push_back(cpu);
+			}
+		}
+		nodes.push_back(cpus);
+	}
+
+	return nodes;
+}
@@ -0,0 +1,55 @@
+#ifndef _SHARDING_H_
+#define _SHARDING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "topology.h"
+#include "traffic.h"
+
+namespace sharding {
+	struct Options {
+		Options();
+
+		unsigned									shards;
+		double										stepDuration;
+		std::size_t									linkCapacity;
+		std::size_t									queueCapacity;
+		bool										pinToNuma;
+	};
+
+	struct Result {
+		std::size_t									steps;
+		std::uint64_t								delivered;
+		std::uint64_t								forwarded;
+		std::uint64_t								dropped;
+		std::uint64_t								unroutable;
+		std::vector<std::uint64_t>					received;
+		std::vector<double>							latency;
+	};
+
+	class ShardedSimulation {
+	public:
+		ShardedSimulation(const std::shared_ptr<const topology::Graph>& graph, const std::vector<traffic::Arrival>& arrivals,
+			const Options& options = Options());
+
+		Result										run(std::size_t maxSteps) const;
+
+		unsigned									shardCount() const;
+		unsigned									shardOf(std::uint32_t node) const;
+		std::uint32_t								crossLinks() const;
+
+		static std::vector<std::vector<int>>		numaNodes();
+
+	private:
+		std::shared_ptr<const topology::Graph>		m_graph;
+		std::vector<traffic::Arrival>				m_arrivals;
+		Options										m_options;
+		std::vector<std::uint32_t>					m_bounds;
+	};
+}
+
+#endif
@@ -0,0 +1,78 @@
+#include "storage.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+const std::size_t storage::SegmentedPool::granularity;
+const std::size_t storage::SegmentedPool::maxPooledSize;
+
+storage::SegmentedPool::SegmentedPool(const std::size_t blockSize, const std::size_t blocksPerSegment)
+	: m_blockSize((std::max(blockSize, sizeof(FreeBlock)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)),
+	m_blocksPerSegment(blocksPerSegment), m_free(nullptr), m_freeCount(0) {
+	if (blockSize == 0 || blocksPerSegment == 0) {
+		throw std::invalid_argument("block size and segment length should be positive");
+	}
+}
+
+void* storage::SegmentedPool::allocate() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_free) {
+		// segments are never returned, blocks stay at stable addresses and are threaded onto the free list
+		std::unique_ptr<unsigned char[]> segment(new unsigned char[m_blockSize * m_blocksPerSegment]);
+		for (auto i = m_blocksPerSegment; i > 0; i--) {
+			auto block = reinterpret_cast<FreeBlock*>(segment.get() + m_blockSize * (i - 1));
+			block->next = m_free;
+			m_free = block;
+		}
+		m_freeCount += m_blocksPerSegment;
+		m_segments.push_back(std::move(segment));
+	}
+
+	auto block = m_free;
+	m_free = block->next;
+	m_freeCount--;
+	return block;
+}
+
+void storage::SegmentedPool::deallocate(void* block) {
+	if (!block) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto freed = static_cast<FreeBlock*>(block);
+	freed->next = m_free;
+	m_free = freed;
+	m_freeCount++;
+}
+
+std::size_t storage::SegmentedPool::blockSize() const {
+	return m_blockSize;
+}
+
+std::size_t storage::SegmentedPool::segmentCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_segments.size();
+}
+
+std::size_t storage::SegmentedPool::freeCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_freeCount;
+}
+
+storage::SegmentedPool& storage::SegmentedPool::forSize(const std::size_t size) {
+	// one pool per size class, deliberately leaked so blocks may outlive static destruction
+	static SegmentedPool* const pools[] = {
+		new SegmentedPool(16), new SegmentedPool(32), new SegmentedPool(48), new SegmentedPool(64),
+		new SegmentedPool(80), new SegmentedPool(96), new SegmentedPool(112), new SegmentedPool(128),
+		new SegmentedPool(144), new SegmentedPool(160), new SegmentedPool(176), new SegmentedPool(192),
+		new SegmentedPool(208), new SegmentedPool(224), new SegmentedPool(240), new SegmentedPool(256)
+	};
+
+	if (size == 0 || size > maxPooledSize) {
+		throw std::invalid_argument("size should be within pooled size classes");
+	}
+
+	return *pools[(size + granularity - 1) / granularity - 1];
+}
@@ -0,0 +1,105 @@
+#ifndef _STORAGE_H_
+#define _STORAGE_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace storage {
+	class SegmentedPool {
+	public:
+		static const std::size_t					granularity = 16;
+		static const std::size_t					maxPooledSize = 256;
+
+		explicit SegmentedPool(std::size_t blockSize, std::size_t blocksPerSegment = 256);
+		SegmentedPool(const SegmentedPool&) = delete;
+
+		const SegmentedPool&						operator=(const SegmentedPool&) = delete;
+
+		void*										allocate();
+		void										deallocate(void* block);
+
+		std::size_t									blockSize() const;
+		std::size_t									segmentCount() const;
+		std::size_t									freeCount() const;
+
+		static SegmentedPool&						forSize(std::size_t size);
+
+	private:
+		struct FreeBlock {
+			FreeBlock*								next;
+		};
+
+		const std::size_t							m_blockSize;
+		const std::size_t							m_blocksPerSegment;
+
+		mutable std::mutex							m_mutex;
+		std::vector<std::unique_ptr<unsigned char[]>>	m_segments;
+		FreeBlock*									m_free;
+		std::size_t									m_freeCount;
+	};
+
+	template<typename T>
+	class PoolAllocator {
+	public:
+		typedef T									value_type;
+
+		PoolAllocator() noexcept;
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept;
+
+		T*											allocate(std::size_t count);
+		void										deallocate(T* pointer, std::size_t count) noexcept;
+
+	private:
+		static bool									isPooled(std::size_t count);
+	};
+
+	template <typename T>
+	PoolAllocator<T>::PoolAllocator() noexcept {
+	}
+
+	template <typename T>
+	template <typename U>
+	PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>&) noexcept {
+	}
+
+	template <typename T>
+	T* PoolAllocator<T>::allocate(const std::size_t count) {
+		if (isPooled(count)) {
+			return static_cast<T*>(SegmentedPool::forSize(count * sizeof(T)).allocate());
+		}
+
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+
+	template <typename T>
+	void PoolAllocator<T>::deallocate(T* pointer, const std::size_t count) noexcept {
+		if (isPooled(count)) {
+			SegmentedPool::forSize(count * sizeof(T)).deallocate(pointer);
+			return;
+		}
+
+		::operator delete(pointer);
+	}
+
+	template <typename T>
+	bool PoolAllocator<T>::isPooled(const std::size_t count) {
+		// small arrays share the size classes with single objects, larger ones fall back to the heap
+		return count > 0 && count <= SegmentedPool::maxPooledSize / sizeof(T) && alignof(T) <= alignof(std::max_align_t);
+	}
+
+	template<typename T, typename U>
+	bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+		return true;
+	}
+
+	template<typename T, typename U>
+	bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+		return false;
+	}
+}
+
+#endif
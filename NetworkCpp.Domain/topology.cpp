@@ -0,0 +1,124 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+const std::uint32_t topology::Graph::none;
+
+topology::Graph::Graph()
+	: m_nodeCount(0), m_outOffsets(1, 0), m_inOffsets(1, 0) {
+}
+
+topology::Graph::Graph(const std::uint32_t nodeCount, const std::vector<Link>& links)
+	: m_nodeCount(nodeCount) {
+	if (nodeCount == none) {
+		throw std::invalid_argument("node count is too large");
+	}
+
+	build(links);
+}
+
+topology::Graph::Graph(const std::vector<entities::Node>& nodes, const std::vector<entities::NodesPair>& pairs)
+	: m_nodeCount(static_cast<std::uint32_t>(nodes.size())) {
+	std::unordered_map<boost::uuids::uuid, std::uint32_t, boost::hash<boost::uuids::uuid>> indices;
+	indices.reserve(nodes.size());
+	for (std::uint32_t i = 0; i < m_nodeCount; i++) {
+		indices.emplace(nodes[i].id(), i);
+	}
+
+	// a pair connects its nodes both ways, every direction becomes its own link
+	std::vector<Link> links;
+	links.reserve(pairs.size() * 2);
+	for (const auto& pair : pairs) {
+		const auto first = indices.find(pair.first().id());
+		const auto second = indices.find(pair.second().id());
+		if (first == indices.end() || second == indices.end()) {
+			throw std::invalid_argument("pair should connect known nodes");
+		}
+
+		links.push_back(Link{ first->second, second->second });
+		links.push_back(Link{ second->second, first->second });
+	}
+
+	build(links);
+}
+
+std::uint32_t topology::Graph::degree(const std::uint32_t node) const {
+	return outEnd(node) - outBegin(node);
+}
+
+std::uint32_t topology::Graph::find(const std::uint32_t source, const std::uint32_t target) const {
+	const auto begin = m_links.begin() + outBegin(source);
+	const auto end = m_links.begin() + outEnd(source);
+	const auto found = std::lower_bound(begin, end, target,
+		[](const Link& link, const std::uint32_t value) { return link.target < value; });
+
+	if (found == end || found->target != target) {
+		return none;
+	}
+
+	return static_cast<std::uint32_t>(found - m_links.begin());
+}
+
+void topology::Graph::build(const std::vector<Link>& links) {
+	if (links.size() >= none) {
+		throw std::invalid_argument("too many links");
+	}
+
+	// counting sort by source keeps construction linear, only each adjacency range is sorted
+	m_outOffsets.assign(m_nodeCount + 1, 0);
+	for (const auto& link : links) {
+		if (link.source >= m_nodeCount || link.target >= m_nodeCount) {
+			throw std::invalid_argument("link should connect existing nodes");
+		}
+		m_outOffsets[link.source + 1]++;
+	}
+
+	for (std::uint32_t node = 0; node < m_nodeCount; node++) {
+		m_outOffsets[node + 1] += m_outOffsets[node];
+	}
+
+	m_links.resize(links.size());
+	{
+		auto positions = std::vector<std::uint32_t>(m_outOffsets.begin(), m_outOffsets.end() - 1);
+		for (const auto& link : links) {
+			m_links[positions[link.source]++] = link;
+		}
+	}
+
+	// drop self loops and parallel links while compacting
+	std::uint32_t written = 0;
+	for (std::uint32_t node = 0; node < m_nodeCount; node++) {
+		const auto begin = m_links.begin() + m_outOffsets[node];
+		const auto end = m_links.begin() + m_outOffsets[node + 1];
+		std::sort(begin, end, [](const Link& lhs, const Link& rhs) { return lhs.target < rhs.target; });
+
+		m_outOffsets[node] = written;
+		for (auto link = begin; link != end; ++link) {
+			if (link->target != node && (written == m_outOffsets[node] || m_links[written - 1].target != link->target)) {
+				m_links[written++] = *link;
+			}
+		}
+	}
+	m_outOffsets[m_nodeCount] = written;
+	m_links.resize(written);
+	m_links.shrink_to_fit();
+
+	m_inOffsets.assign(m_nodeCount + 1, 0);
+	for (const auto& link : m_links) {
+		m_inOffsets[link.target + 1]++;
+	}
+
+	for (std::uint32_t node = 0; node < m_nodeCount; node++) {
+		m_inOffsets[node + 1] += m_inOffsets[node];
+	}
+
+	m_inLinks.resize(m_links.size());
+	auto positions = std::vector<std::uint32_t>(m_inOffsets.begin(), m_inOffsets.end() - 1);
+	for (std::uint32_t index = 0; index < m_links.size(); index++) {
+		m_inLinks[positions[m_links[index].target]++] = index;
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "entities.h"
+
+namespace topology {
+	struct Link {
+		std::uint32_t								source;
+		std::uint32_t								target;
+	};
+
+	class Graph {
+	public:
+		static const std::uint32_t					none = 0xffffffffu;
+
+		Graph();
+		Graph(std::uint32_t nodeCount, const std::vector<Link>& links);
+		Graph(const std::vector<entities::Node>& nodes, const std::vector<entities::NodesPair>& pairs);
+
+		std::uint32_t								nodeCount() const;
+		std::uint32_t								linkCount() const;
+		const Link&									link(std::uint32_t index) const;
+
+		std::uint32_t								outBegin(std::uint32_t node) const;
+		std::uint32_t								outEnd(std::uint32_t node) const;
+		std::uint32_t								inBegin(std::uint32_t node) const;
+		std::uint32_t								inEnd(std::uint32_t node) const;
+		std::uint32_t								inLink(std::uint32_t position) const;
+
+		std::uint32_t								degree(std::uint32_t node) const;
+		std::uint32_t								find(std::uint32_t source, std::uint32_t target) const;
+
+	private:
+		std::uint32_t								m_nodeCount;
+		std::vector<Link>							m_links;
+		std::vector<std::uint32_t>					m_outOffsets;
+		std::vector<std::uint32_t>					m_inOffsets;
+		std::vector<std::uint32_t>					m_inLinks;
+
+		void										build(const std::vector<Link>& links);
+	};
+
+	inline std::uint32_t Graph::nodeCount() const {
+		return m_nodeCount;
+	}
+
+	inline std::uint32_t Graph::linkCount() const {
+		return static_cast<std::uint32_t>(m_links.size());
+	}
+
+	inline const Link& Graph::link(const std::uint32_t index) const {
+		return m_links[index];
+	}
+
+	inline std::uint32_t Graph::outBegin(const std::uint32_t node) const {
+		return m_outOffsets[node];
+	}
+
+	inline std::uint32_t Graph::outEnd(const std::uint32_t node) const {
+		return m_outOffsets[node + 1];
+	}
+
+	inline std::uint32_t Graph::inBegin(const std::uint32_t node) const {
+		return m_inOffsets[node];
+	}
+
+	inline std::uint32_t Graph::inEnd(const std::uint32_t node) const {
+		return m_inOffsets[node + 1];
+	}
+
+	inline std::uint32_t Graph::inLink(const std::uint32_t position) const {
+		return m_inLinks[position];
+	}
+}
+
+#endif
@@ -0,0 +1,280 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+	const char* const			processNames[] = { "links", "nodes", "channels" };
+	const char* const			trackNames[] = { "link ", "node ", "channel " };
+	const std::size_t			flushSize = 1 << 16;
+
+	const tracing::Options& validated(const tracing::Options& options) {
+		if (options.timeScale <= 0 || options.counterInterval < 0 || options.dropSampling == 0) {
+			throw std::invalid_argument("time scale and drop sampling should be positive");
+		}
+
+		return options;
+	}
+
+	void appendEscaped(std::string& buffer, const std::string& text) {
+		for (auto character : text) {
+			if (character == '"' || character == '\\') {
+				buffer += '\\';
+				buffer += character;
+			}
+			else if (static_cast<unsigned char>(character) < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(character));
+				buffer += escaped;
+			}
+			else {
+				buffer += character;
+			}
+		}
+	}
+}
+
+tracing::Options::Options()
+	: timeScale(1e6), counterInterval(0), dropSampling(1) {
+}
+
+tracing::TraceWriter::TraceWriter(const std::string& path, const Options& options)
+	: m_options(validated(options)), m_file(new std::ofstream(path, std::ios::trunc)), m_stream(*m_file),
+	m_hasProcess(), m_events(0), m_time(0), m_isClosed(false) {
+	if (!*m_file) {
+		throw std::runtime_error("cannot open trace " + path);
+	}
+
+	m_buffer = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+}
+
+tracing::TraceWriter::TraceWriter(std::ostream& stream, const Options& options)
+	: m_options(validated(options)), m_stream(stream), m_hasProcess(), m_events(0), m_time(0), m_isClosed(false) {
+	m_buffer = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+}
+
+tracing::TraceWriter::~TraceWriter() {
+	if (m_isClosed) {
+		return;
+	}
+
+	try {
+		close(m_time);
+	}
+	catch (const std::exception&) {
+	}
+}
+
+void tracing::TraceWriter::name(const Kind kind, const std::uint32_t index, const std::string& name) {
+	if (track(kind, index)) {
+		describe(kind, index, name);
+	}
+}
+
+void tracing::TraceWriter::busy(const Kind kind, const std::uint32_t index, const double time, const bool isBusy) {
+	m_time = std::max(m_time, time);
+	auto state = track(kind, index);
+	if (!state || state->isBusy == isBusy) {
+		return;
+	}
+
+	// a span ending where the next one starts is held back and merged, so a link refilled every step is one span
+	state->isBusy = isBusy;
+	if (!isBusy) {
+		state->busyUntil = time;
+		state->isPending = true;
+		return;
+	}
+
+	if (state->isPending && time > state->busyUntil) {
+		appendSpan(kind, index, *state);
+		state->busySince = time;
+	}
+	else if (!state->isPending) {
+		state->busySince = time;
+	}
+	state->isPending = false;
+}
+
+void tracing::TraceWriter::counter(const Kind kind, const std::uint32_t index, const double time, const std::uint64_t value) {
+	m_time = std::max(m_time, time);
+	auto state = track(kind, index);
+	if (!state || (state->hasCounter && state->counter == value)) {
+		return;
+	}
+
+	// samples closer than the interval are skipped, except a drain to zero so idle queues never look loaded
+	if (state->hasCounter && value != 0 && time - state->counterAt < m_options.counterInterval) {
+		return;
+	}
+
+	state->hasCounter = true;
+	state->counter = value;
+	state->counterAt = time;
+
+	begin("depth", "C", kind, index, time);
+	m_buffer += ",\"id\":";
+	m_buffer += std::to_string(index);
+	m_buffer += ",\"args\":{\"value\":";
+	m_buffer += std::to_string(value);
+	m_buffer += '}';
+	end();
+}
+
+void tracing::TraceWriter::drop(const Kind kind, const std::uint32_t index, const double time) {
+	m_time = std::max(m_time, time);
+	auto state = track(kind, index);
+	if (!state) {
+		return;
+	}
+
+	state->drops++;
+	if ((state->drops - 1) % m_options.dropSampling != 0) {
+		return;
+	}
+
+	begin("drop", "i", kind, index, time);
+	m_buffer += ",\"s\":\"t\",\"args\":{\"total\":";
+	m_buffer += std::to_string(state->drops);
+	m_buffer += '}';
+	end();
+}
+
+void tracing::TraceWriter::sample(const std::vector<entities::Channel*>& channels, const double time) {
+	for (std::uint32_t i = 0; i < channels.size(); i++) {
+		busy(Kind::Channel, i, time, channels[i]->isBusy());
+	}
+}
+
+void tracing::TraceWriter::flush() {
+	m_stream.write(m_buffer.data(), m_buffer.size());
+	m_stream.flush();
+	m_buffer.clear();
+
+	if (!m_stream) {
+		throw std::runtime_error("cannot write trace");
+	}
+}
+
+void tracing::TraceWriter::close(const double time) {
+	if (m_isClosed) {
+		return;
+	}
+
+	// spans still open are cut at the closing time so they are not lost
+	for (std::uint32_t kind = 0; kind < 3; kind++) {
+		for (std::uint32_t index = 0; index < m_tracks[kind].size(); index++) {
+			auto& state = m_tracks[kind][index];
+			if (state.isBusy) {
+				state.busyUntil = std::max(time, state.busySince);
+				state.isBusy = false;
+				state.isPending = true;
+			}
+			if (state.isPending) {
+				appendSpan(static_cast<Kind>(kind + 1), index, state);
+				state.isPending = false;
+			}
+		}
+	}
+
+	m_buffer += "\n]}\n";
+	m_isClosed = true;
+	flush();
+	if (m_file) {
+		m_file->close();
+	}
+}
+
+bool tracing::TraceWriter::isClosed() const {
+	return m_isClosed;
+}
+
+std::uint64_t tracing::TraceWriter::eventCount() const {
+	return m_events;
+}
+
+tracing::TraceWriter::Track* tracing::TraceWriter::track(const Kind kind, const std::uint32_t index) {
+	if (m_isClosed) {
+		throw std::logic_error("trace is closed");
+	}
+
+	auto& tracks = m_tracks[static_cast<std::uint32_t>(kind) - 1];
+	if (index >= tracks.size()) {
+		tracks.resize(index + 1, Track{ 0, 0, 0, 0, 0, false, false, false, false, false });
+	}
+
+	// the filter runs once per track, later events only read the cached answer
+	auto& state = tracks[index];
+	if (!state.isKnown) {
+		state.isKnown = true;
+		state.isFiltered = m_options.filter && !m_options.filter(kind, index);
+		if (!state.isFiltered) {
+			describe(kind, index, trackNames[static_cast<std::uint32_t>(kind) - 1] + std::to_string(index));
+		}
+	}
+
+	return state.isFiltered ? nullptr : &state;
+}
+
+void tracing::TraceWriter::describe(const Kind kind, const std::uint32_t index, const std::string& name) {
+	const auto process = static_cast<std::uint32_t>(kind);
+	if (!m_hasProcess[process - 1]) {
+		m_hasProcess[process - 1] = true;
+		m_buffer += m_events > 0 ? "," : "";
+		m_buffer += "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+		m_buffer += std::to_string(process);
+		m_buffer += ",\"args\":{\"name\":\"";
+		m_buffer += processNames[process - 1];
+		m_buffer += "\"}";
+		end();
+	}
+
+	m_buffer += m_events > 0 ? "," : "";
+	m_buffer += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":";
+	m_buffer += std::to_string(process);
+	m_buffer += ",\"tid\":";
+	m_buffer += std::to_string(index);
+	m_buffer += ",\"args\":{\"name\":\"";
+	appendEscaped(m_buffer, name);
+	m_buffer += "\"}";
+	end();
+}
+
+void tracing::TraceWriter::begin(const char* name, const char* phase, const Kind kind, const std::uint32_t index,
+	const double time) {
+	m_buffer += m_events > 0 ? "," : "";
+	m_buffer += "\n{\"name\":\"";
+	m_buffer += name;
+	m_buffer += "\",\"ph\":\"";
+	m_buffer += phase;
+	m_buffer += "\",\"pid\":";
+	m_buffer += std::to_string(static_cast<std::uint32_t>(kind));
+	m_buffer += ",\"tid\":";
+	m_buffer += std::to_string(index);
+	m_buffer += ",\"ts\":";
+	appendTime(time);
+}
+
+void tracing::TraceWriter::end() {
+	m_buffer += '}';
+	m_events++;
+
+	if (m_buffer.size() >= flushSize) {
+		flush();
+	}
+}
+
+void tracing::TraceWriter::appendSpan(const Kind kind, const std::uint32_t index, const Track& state) {
+	// one complete event per busy period keeps the file at half the size of begin/end pairs
+	begin("busy", "X", kind, index, state.busySince);
+	m_buffer += ",\"dur\":";
+	appendTime(state.busyUntil - state.busySince);
+	end();
+}
+
+void tracing::TraceWriter::appendTime(const double time) {
+	char formatted[32];
+	std::snprintf(formatted, sizeof(formatted), "%.3f", time * m_options.timeScale);
+	m_buffer += formatted;
+}
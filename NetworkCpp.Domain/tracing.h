@@ -0,0 +1,89 @@
+#ifndef _TRACING_H_
+#define _TRACING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "entities.h"
+
+namespace tracing {
+	// every kind is written as its own trace process so viewers group the tracks
+	enum class Kind : std::uint32_t {
+		Link = 1,
+		Node = 2,
+		Channel = 3
+	};
+
+	struct Options {
+		Options();
+
+		double										timeScale;
+		double										counterInterval;
+		std::uint32_t								dropSampling;
+		std::function<bool(Kind, std::uint32_t)>	filter;
+	};
+
+	class TraceWriter {
+	public:
+		explicit TraceWriter(const std::string& path, const Options& options = Options());
+		explicit TraceWriter(std::ostream& stream, const Options& options = Options());
+		TraceWriter(const TraceWriter&) = delete;
+
+		~TraceWriter();
+
+		const TraceWriter&							operator=(const TraceWriter&) = delete;
+
+		void										name(Kind kind, std::uint32_t index, const std::string& name);
+		void										busy(Kind kind, std::uint32_t index, double time, bool isBusy);
+		void										counter(Kind kind, std::uint32_t index, double time, std::uint64_t value);
+		void										drop(Kind kind, std::uint32_t index, double time);
+		void										sample(const std::vector<entities::Channel*>& channels, double time);
+
+		void										flush();
+		void										close(double time);
+
+		bool										isClosed() const;
+		std::uint64_t								eventCount() const;
+
+	private:
+		struct Track {
+			double									busySince;
+			double									busyUntil;
+			double									counterAt;
+			std::uint64_t							counter;
+			std::uint64_t							drops;
+			bool									isBusy;
+			bool									isPending;
+			bool									hasCounter;
+			bool									isKnown;
+			bool									isFiltered;
+		};
+
+		const Options								m_options;
+		std::unique_ptr<std::ofstream>				m_file;
+		std::ostream&								m_stream;
+		std::string									m_buffer;
+		std::vector<Track>							m_tracks[3];
+		bool										m_hasProcess[3];
+
+		std::uint64_t								m_events;
+		double										m_time;
+		bool										m_isClosed;
+
+		Track*										track(Kind kind, std::uint32_t index);
+		void										describe(Kind kind, std::uint32_t index, const std::string& name);
+		void										begin(const char* name, const char* phase, Kind kind, std::uint32_t index,
+														double time);
+		void										end();
+		void										appendSpan(Kind kind, std::uint32_t index, const Track& state);
+		void										appendTime(double time);
+	};
+}
+
+#endif
@@ -0,0 +1,390 @@
+#include "traffic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+const std::size_t traffic::TrafficGenerator::batchSize;
+
+traffic::ArrivalProcess::ArrivalProcess()
+	: m_time(0) {
+}
+
+double traffic::ArrivalProcess::time() const {
+	return m_time;
+}
+
+std::vector<double> traffic::ArrivalProcess::state() const {
+	return std::vector<double>{ m_time };
+}
+
+void traffic::ArrivalProcess::setState(const std::vector<double>& state) {
+	if (state.empty()) {
+		throw std::invalid_argument("arrival process state is empty");
+	}
+
+	m_time = state[0];
+}
+
+traffic::PoissonArrivals::PoissonArrivals(const double rate)
+	: ArrivalProcess(), m_rate(rate) {
+	if (rate <= 0) {
+		throw std::invalid_argument("arrival rate should be positive");
+	}
+}
+
+std::size_t traffic::PoissonArrivals::next(rng::Xoshiro256x4& rng, double* times, const std::size_t count) {
+	rng.fillUnit(times, count);
+
+	const auto mean = 1.0 / m_rate;
+	for (std::size_t i = 0; i < count; i++) {
+		times[i] = -std::log(times[i]) * mean;
+	}
+
+	for (std::size_t i = 0; i < count; i++) {
+		m_time += times[i];
+		times[i] = m_time;
+	}
+
+	return count;
+}
+
+traffic::OnOffArrivals::OnOffArrivals(const double rate, const double meanOn, const double meanOff)
+	: ArrivalProcess(), m_rate(rate), m_meanOn(meanOn), m_meanOff(meanOff), m_remainingOn(meanOn) {
+	if (rate <= 0 || meanOn <= 0 || meanOff < 0) {
+		throw std::invalid_argument("on/off parameters should be positive");
+	}
+}
+
+std::size_t traffic::OnOffArrivals::next(rng::Xoshiro256x4& rng, double* times, const std::size_t count) {
+	rng.fillUnit(times, count);
+
+	const auto mean = 1.0 / m_rate;
+	for (std::size_t i = 0; i < count; i++) {
+		times[i] = -std::log(times[i]) * mean;
+	}
+
+	for (std::size_t i = 0; i < count; i++) {
+		auto gap = times[i];
+
+		// arrivals are memoryless, so a gap that outlives the burst is redrawn after the silence
+		while (gap > m_remainingOn) {
+			double periods[2];
+			rng.fillUnit(periods, 2);
+
+			m_time += m_remainingOn - std::log(periods[0]) * m_meanOff;
+			m_remainingOn = -std::log(periods[1]) * m_meanOn;
+
+			rng.fillUnit(&gap, 1);
+			gap = -std::log(gap) * mean;
+		}
+
+		m_remainingOn -= gap;
+		m_time += gap;
+		times[i] = m_time;
+	}
+
+	return count;
+}
+
+std::vector<double> traffic::OnOffArrivals::state() const {
+	auto state = ArrivalProcess::state();
+	state.push_back(m_remainingOn);
+	return state;
+}
+
+void traffic::OnOffArrivals::setState(const std::vector<double>& state) {
+	if (state.size() < 2) {
+		throw std::invalid_argument("on/off state is incomplete");
+	}
+
+	ArrivalProcess::setState(state);
+	m_remainingOn = state[1];
+}
+
+traffic::ParetoArrivals::ParetoArrivals(const double rate, const double shape)
+	: ArrivalProcess(), m_scale((shape - 1) / (shape * rate)), m_exponent(-1.0 / shape) {
+	if (rate <= 0 || shape <= 1) {
+		throw std::invalid_argument("pareto arrivals need a positive rate and a shape above one");
+	}
+}
+
+std::size_t traffic::ParetoArrivals::next(rng::Xoshiro256x4& rng, double* times, const std::size_t count) {
+	rng.fillUnit(times, count);
+
+	for (std::size_t i = 0; i < count; i++) {
+		times[i] = m_scale * std::pow(times[i], m_exponent);
+	}
+
+	for (std::size_t i = 0; i < count; i++) {
+		m_time += times[i];
+		times[i] = m_time;
+	}
+
+	return count;
+}
+
+traffic::TraceArrivals::TraceArrivals(const std::vector<double>& times, const double period)
+	: ArrivalProcess(), m_times(times), m_period(period), m_position(0), m_offset(0) {
+	if (!std::is_sorted(m_times.cbegin(), m_times.cend())) {
+		throw std::invalid_argument("trace timestamps should be sorted");
+	}
+
+	if (period > 0 && !m_times.empty() && m_times.back() >= period) {
+		throw std::invalid_argument("trace should fit into its period");
+	}
+}
+
+std::size_t traffic::TraceArrivals::next(rng::Xoshiro256x4&, double* times, const std::size_t count) {
+	std::size_t produced = 0;
+
+	while (produced < count && !m_times.empty()) {
+		if (m_position == m_times.size()) {
+			if (m_period <= 0) {
+				break;
+			}
+
+			m_position = 0;
+			m_offset += m_period;
+		}
+
+		const auto length = std::min(count - produced, m_times.size() - m_position);
+		for (std::size_t i = 0; i < length; i++) {
+			times[produced + i] = m_offset + m_times[m_position + i];
+		}
+
+		produced += length;
+		m_position += length;
+		m_time = times[produced - 1];
+	}
+
+	return produced;
+}
+
+std::vector<double> traffic::TraceArrivals::state() const {
+	auto state = ArrivalProcess::state();
+	state.push_back(static_cast<double>(m_position));
+	state.push_back(m_offset);
+	return state;
+}
+
+void traffic::TraceArrivals::setState(const std::vector<double>& state) {
+	if (state.size() < 3 || state[1] > m_times.size()) {
+		throw std::invalid_argument("trace state doesn't match the trace");
+	}
+
+	ArrivalProcess::setState(state);
+	m_position = static_cast<std::size_t>(state[1]);
+	m_offset = state[2];
+}
+
+traffic::ConstantSize::ConstantSize(const int size)
+	: m_size(size) {
+}
+
+void traffic::ConstantSize::next(rng::Xoshiro256x4&, int* sizes, const std::size_t count) {
+	std::fill(sizes, sizes + count, m_size);
+}
+
+traffic::UniformSize::UniformSize(const int min, const int max)
+	: m_min(min), m_range(static_cast<std::uint32_t>(max - min) + 1) {
+	if (max < min) {
+		throw std::invalid_argument("size range is empty");
+	}
+}
+
+void traffic::UniformSize::next(rng::Xoshiro256x4& rng, int* sizes, const std::size_t count) {
+	const std::size_t chunk = 256;
+	std::uint64_t raw[chunk];
+
+	for (std::size_t index = 0; index < count; index += chunk) {
+		const auto length = std::min(chunk, count - index);
+		rng.fill(raw, length);
+		for (std::size_t i = 0; i < length; i++) {
+			sizes[index + i] = m_min + static_cast<int>(rng::toIndex(raw[i], m_range));
+		}
+	}
+}
+
+traffic::ParetoSize::ParetoSize(const int min, const double shape, const int max)
+	: m_min(min), m_exponent(-1.0 / shape), m_max(max) {
+	if (min <= 0 || shape <= 0 || max < min) {
+		throw std::invalid_argument("pareto sizes need a positive minimum, shape and cap");
+	}
+}
+
+void traffic::ParetoSize::next(rng::Xoshiro256x4& rng, int* sizes, const std::size_t count) {
+	const std::size_t chunk = 256;
+	double uniforms[chunk];
+
+	for (std::size_t index = 0; index < count; index += chunk) {
+		const auto length = std::min(chunk, count - index);
+		rng.fillUnit(uniforms, length);
+		for (std::size_t i = 0; i < length; i++) {
+			sizes[index + i] = static_cast<int>(std::min(m_max, m_min * std::pow(uniforms[i], m_exponent)));
+		}
+	}
+}
+
+traffic::EmpiricalSize::EmpiricalSize(const std::vector<int>& sizes, const std::vector<double>& weights)
+	: m_sizes(sizes), m_probabilities(sizes.size()), m_aliases(sizes.size()) {
+	if (sizes.empty() || sizes.size() != weights.size()) {
+		throw std::invalid_argument("every size needs exactly one weight");
+	}
+
+	double total = 0;
+	for (auto weight : weights) {
+		if (weight < 0) {
+			throw std::invalid_argument("weights should be non-negative");
+		}
+		total += weight;
+	}
+
+	if (total <= 0) {
+		throw std::invalid_argument("at least one weight should be positive");
+	}
+
+	// Vose's alias method: one uniform index plus one coin flip per sample
+	const auto count = sizes.size();
+	std::vector<double> scaled(count);
+	std::vector<std::uint32_t> small, large;
+
+	for (std::size_t i = 0; i < count; i++) {
+		scaled[i] = weights[i] * count / total;
+		(scaled[i] < 1 ? small : large).push_back(static_cast<std::uint32_t>(i));
+	}
+
+	while (!small.empty() && !large.empty()) {
+		const auto less = small.back();
+		const auto more = large.back();
+		small.pop_back();
+
+		m_probabilities[less] = scaled[less];
+		m_aliases[less] = more;
+
+		scaled[more] -= 1 - scaled[less];
+		if (scaled[more] < 1) {
+			large.pop_back();
+			small.push_back(more);
+		}
+	}
+
+	for (auto index : large) {
+		m_probabilities[index] = 1;
+		m_aliases[index] = index;
+	}
+
+	for (auto index : small) {
+		m_probabilities[index] = 1;
+		m_aliases[index] = index;
+	}
+}
+
+void traffic::EmpiricalSize::next(rng::Xoshiro256x4& rng, int* sizes, const std::size_t count) {
+	const std::size_t chunk = 256;
+	std::uint64_t raw[chunk];
+	const auto bound = static_cast<std::uint32_t>(m_sizes.size());
+
+	for (std::size_t index = 0; index < count; index += chunk) {
+		const auto length = std::min(chunk, count - index);
+		rng.fill(raw, length);
+		for (std::size_t i = 0; i < length; i++) {
+			const auto column = rng::toIndex(raw[i], bound);
+			const auto coin = (raw[i] & 0xffffffffULL) * (1.0 / 4294967296.0);
+			sizes[index + i] = m_sizes[coin < m_probabilities[column] ? column : m_aliases[column]];
+		}
+	}
+}
+
+traffic::TrafficGenerator::TrafficGenerator(const std::uint32_t nodeCount, const std::shared_ptr<ArrivalProcess>& arrivals,
+	const std::shared_ptr<SizeDistribution>& sizes, const std::uint64_t seed)
+	: m_nodeCount(nodeCount), m_arrivals(arrivals), m_sizes(sizes), m_rng(seed)
+		, m_batchTimes(batchSize), m_batchSizes(batchSize), m_batchEndpoints(batchSize) {
+	if (nodeCount < 2) {
+		throw std::invalid_argument("traffic needs at least two nodes");
+	}
+}
+
+traffic::TrafficGenerator::TrafficGenerator(const std::vector<entities::Node>& nodes, const std::shared_ptr<ArrivalProcess>& arrivals,
+	const std::shared_ptr<SizeDistribution>& sizes, const std::uint64_t seed)
+	: TrafficGenerator(static_cast<std::uint32_t>(nodes.size()), arrivals, sizes, seed) {
+}
+
+std::size_t traffic::TrafficGenerator::generate(Arrival* out, const std::size_t count) {
+	std::size_t produced = 0;
+
+	while (produced < count) {
+		const auto requested = std::min(batchSize, count - produced);
+		const auto length = m_arrivals->next(m_rng, m_batchTimes.data(), requested);
+		if (length == 0) {
+			break;
+		}
+
+		m_sizes->next(m_rng, m_batchSizes.data(), length);
+		m_rng.fill(m_batchEndpoints.data(), length);
+
+		// the low half picks the source, the high half one of the other n - 1 nodes
+		for (std::size_t i = 0; i < length; i++) {
+			const auto source = rng::toIndex(m_batchEndpoints[i] << 32, m_nodeCount);
+			auto destination = source + 1 + rng::toIndex(m_batchEndpoints[i], m_nodeCount - 1);
+			if (destination >= m_nodeCount) {
+				destination -= m_nodeCount;
+			}
+
+			auto& arrival = out[produced + i];
+			arrival.time = m_batchTimes[i];
+			arrival.source = source;
+			arrival.destination = destination;
+			arrival.size = m_batchSizes[i];
+		}
+
+		produced += length;
+		if (length < requested) {
+			break;
+		}
+	}
+
+	return produced;
+}
+
+std::size_t traffic::TrafficGenerator::generate(std::vector<Arrival>& out, const std::size_t count) {
+	const auto offset = out.size();
+	out.resize(offset + count);
+
+	const auto produced = generate(out.data() + offset, count);
+	out.resize(offset + produced);
+
+	return produced;
+}
+
+void traffic::TrafficGenerator::deliver(const Arrival* arrivals, const std::size_t count, std::vector<entities::Node>& nodes) {
+	for (std::size_t i = 0; i < count; i++) {
+		auto& sender = nodes[arrivals[i].source];
+		auto message = entities::Message(arrivals[i].size, sender, nodes[arrivals[i].destination]);
+		message.setSentAt(arrivals[i].time);
+		sender.send(message);
+	}
+}
+
+std::uint32_t traffic::TrafficGenerator::nodeCount() const {
+	return m_nodeCount;
+}
+
+double traffic::TrafficGenerator::time() const {
+	return m_arrivals->time();
+}
+
+void traffic::TrafficGenerator::state(std::vector<std::uint64_t>& rngState, std::vector<double>& processState) const {
+	rngState.resize(rng::Xoshiro256x4::stateSize);
+	m_rng.state(rngState.data());
+	processState = m_arrivals->state();
+}
+
+void traffic::TrafficGenerator::setState(const std::vector<std::uint64_t>& rngState, const std::vector<double>& processState) {
+	if (rngState.size() != rng::Xoshiro256x4::stateSize) {
+		throw std::invalid_argument("generator state has a wrong size");
+	}
+
+	m_rng.setState(rngState.data());
+	m_arrivals->setState(processState);
+}
@@ -0,0 +1,174 @@
+#ifndef _TRAFFIC_H_
+#define _TRAFFIC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "entities.h"
+#include "rng.h"
+
+namespace traffic {
+	struct Arrival {
+		double										time;
+		std::uint32_t								source;
+		std::uint32_t								destination;
+		int											size;
+	};
+
+	class ArrivalProcess {
+	public:
+		ArrivalProcess();
+
+		virtual ~ArrivalProcess() = default;
+
+		virtual std::size_t							next(rng::Xoshiro256x4& rng, double* times, std::size_t count) = 0;
+
+		double										time() const;
+
+		virtual std::vector<double>					state() const;
+		virtual void								setState(const std::vector<double>& state);
+
+	protected:
+		double										m_time;
+	};
+
+	class PoissonArrivals : public ArrivalProcess {
+	public:
+		explicit PoissonArrivals(double rate);
+
+		std::size_t									next(rng::Xoshiro256x4& rng, double* times, std::size_t count) override;
+
+	private:
+		const double								m_rate;
+	};
+
+	class OnOffArrivals : public ArrivalProcess {
+	public:
+		OnOffArrivals(double rate, double meanOn, double meanOff);
+
+		std::size_t									next(rng::Xoshiro256x4& rng, double* times, std::size_t count) override;
+
+		std::vector<double>							state() const override;
+		void										setState(const std::vector<double>& state) override;
+
+	private:
+		const double								m_rate;
+		const double								m_meanOn;
+		const double								m_meanOff;
+		double										m_remainingOn;
+	};
+
+	class ParetoArrivals : public ArrivalProcess {
+	public:
+		ParetoArrivals(double rate, double shape);
+
+		std::size_t									next(rng::Xoshiro256x4& rng, double* times, std::size_t count) override;
+
+	private:
+		const double								m_scale;
+		const double								m_exponent;
+	};
+
+	class TraceArrivals : public ArrivalProcess {
+	public:
+		explicit TraceArrivals(const std::vector<double>& times, double period = 0);
+
+		std::size_t									next(rng::Xoshiro256x4& rng, double* times, std::size_t count) override;
+
+		std::vector<double>							state() const override;
+		void										setState(const std::vector<double>& state) override;
+
+	private:
+		const std::vector<double>					m_times;
+		const double								m_period;
+		std::size_t									m_position;
+		double										m_offset;
+	};
+
+	class SizeDistribution {
+	public:
+		virtual ~SizeDistribution() = default;
+
+		virtual void								next(rng::Xoshiro256x4& rng, int* sizes, std::size_t count) = 0;
+	};
+
+	class ConstantSize : public SizeDistribution {
+	public:
+		explicit ConstantSize(int size);
+
+		void										next(rng::Xoshiro256x4& rng, int* sizes, std::size_t count) override;
+
+	private:
+		const int									m_size;
+	};
+
+	class UniformSize : public SizeDistribution {
+	public:
+		UniformSize(int min, int max);
+
+		void										next(rng::Xoshiro256x4& rng, int* sizes, std::size_t count) override;
+
+	private:
+		const int									m_min;
+		const std::uint32_t							m_range;
+	};
+
+	class ParetoSize : public SizeDistribution {
+	public:
+		ParetoSize(int min, double shape, int max);
+
+		void										next(rng::Xoshiro256x4& rng, int* sizes, std::size_t count) override;
+
+	private:
+		const double								m_min;
+		const double								m_exponent;
+		const double								m_max;
+	};
+
+	class EmpiricalSize : public SizeDistribution {
+	public:
+		EmpiricalSize(const std::vector<int>& sizes, const std::vector<double>& weights);
+
+		void										next(rng::Xoshiro256x4& rng, int* sizes, std::size_t count) override;
+
+	private:
+		std::vector<int>							m_sizes;
+		std::vector<double>							m_probabilities;
+		std::vector<std::uint32_t>					m_aliases;
+	};
+
+	class TrafficGenerator {
+	public:
+		TrafficGenerator(std::uint32_t nodeCount, const std::shared_ptr<ArrivalProcess>& arrivals,
+			const std::shared_ptr<SizeDistribution>& sizes, std::uint64_t seed);
+		TrafficGenerator(const std::vector<entities::Node>& nodes, const std::shared_ptr<ArrivalProcess>& arrivals,
+			const std::shared_ptr<SizeDistribution>& sizes, std::uint64_t seed);
+
+		std::size_t									generate(Arrival* out, std::size_t count);
+		std::size_t									generate(std::vector<Arrival>& out, std::size_t count);
+
+		static void									deliver(const Arrival* arrivals, std::size_t count, std::vector<entities::Node>& nodes);
+
+		std::uint32_t								nodeCount() const;
+		double										time() const;
+
+		void										state(std::vector<std::uint64_t>& rngState, std::vector<double>& processState) const;
+		void										setState(const std::vector<std::uint64_t>& rngState, const std::vector<double>& processState);
+
+	private:
+		static const std::size_t					batchSize = 1024;
+
+		const std::uint32_t							m_nodeCount;
+		std::shared_ptr<ArrivalProcess>				m_arrivals;
+		std::shared_ptr<SizeDistribution>			m_sizes;
+		rng::Xoshiro256x4							m_rng;
+
+		std::vector<double>							m_batchTimes;
+		std::vector<int>							m_batchSizes;
+		std::vector<std::uint64_t>					m_batchEndpoints;
+	};
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "aggregation.h"
+#include "forwarding.h"
+
+class AggregationTests : public testing::Test {
+};
+
+namespace {
+	entities::Message delivered(const entities::Node& sender, const entities::Node& receiver, const int size,
+		const double sentAt, const double receivedAt) {
+		auto message = entities::Message(size, sender, receiver);
+		message.setSentAt(sentAt);
+		message.setReceivedAt(receivedAt);
+		return message;
+	}
+}
+
+TEST(AggregationTests, TotalsShouldCoverEveryDelivery) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto aggregator = aggregation::ReceiveAggregator(2, 1.0, 0, 1e-3);
+
+	// act
+	aggregator.add(delivered(nodes[0], nodes[2], 10, 0.0, 0.001));
+	aggregator.add(delivered(nodes[1], nodes[2], 20, 0.0, 0.002));
+	aggregator.add(delivered(nodes[0], nodes[2], 30, 1.0, 1.004));
+
+	// assert
+	EXPECT_EQ(aggregator.count(), 3u);
+	EXPECT_EQ(aggregator.bytes(), 60u);
+	EXPECT_EQ(aggregator.senderCount(), 2u);
+	EXPECT_EQ(aggregator.sender(nodes[0].id()).count, 2u);
+	EXPECT_EQ(aggregator.sender(nodes[0].id()).bytes, 40u);
+	EXPECT_EQ(aggregator.sender(nodes[2].id()).count, 0u);
+	EXPECT_EQ(aggregator.latency().count(), 3u);
+	EXPECT_EQ(aggregator.latency().max(), 4u);
+	auto recent = aggregator.recent();
+	ASSERT_EQ(recent.size(), 2u);
+	EXPECT_EQ(recent[0].size(), 20);
+	EXPECT_EQ(recent[1].size(), 30);
+}
+
+TEST(AggregationTests, WindowShouldBeSampled) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	auto aggregator = aggregation::ReceiveAggregator(16, 0.25, 7);
+	auto message = delivered(nodes[0], nodes[1], 1, 0.0, 1.0);
+
+	// act
+	for (auto i = 0; i < 100000; i++) {
+		aggregator.add(message);
+	}
+
+	// assert
+	EXPECT_EQ(aggregator.count(), 100000u);
+	EXPECT_NEAR(static_cast<double>(aggregator.sampled()), 25000.0, 500.0);
+	EXPECT_EQ(aggregator.recent().size(), 16u);
+	EXPECT_THROW(aggregation::ReceiveAggregator(1, 1.5), std::invalid_argument);
+}
+
+TEST(AggregationTests, StreamingNodeShouldNotKeepMessages) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	std::vector<topology::Link> links = { { 0, 1 }, { 1, 2 } };
+	auto routes = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(3, links));
+	auto engine = forwarding::ForwardingEngine(nodes, routes, 1.0, 4);
+	auto aggregator = std::make_shared<aggregation::ReceiveAggregator>(4, 1.0, 0, 1.0);
+	nodes[2].setAggregator(aggregator);
+
+	// act
+	for (auto i = 0; i < 10; i++) {
+		nodes[0].buffer().add(entities::Message(5, nodes[0], nodes[2]));
+		nodes[1].buffer().add(entities::Message(1, nodes[1], nodes[2]));
+	}
+	engine.run(100);
+
+	// assert
+	EXPECT_EQ(engine.delivered(), 20u);
+	EXPECT_EQ(nodes[2].receivedCount(), 0);
+	EXPECT_EQ(nodes[2].aggregator(), aggregator);
+	EXPECT_EQ(aggregator->count(), 20u);
+	EXPECT_EQ(aggregator->sender(nodes[0].id()).bytes, 50u);
+	EXPECT_EQ(aggregator->recent().size(), 4u);
+	EXPECT_EQ(aggregator->latency().max(), 5u);
+	EXPECT_EQ(nodes[1].aggregator(), nullptr);
+}
+
+TEST(AggregationTests, CopiedNodeShouldOwnItsAggregator) {
+	// arrange
+	entities::Node sender;
+	entities::Node node;
+	node.setAggregator(std::make_shared<aggregation::ReceiveAggregator>(2));
+	node.receive(delivered(sender, node, 8, 0, 1));
+
+	// act
+	entities::Node copy(node);
+	entities::Node assigned;
+	assigned = node;
+	copy.receive(delivered(sender, node, 8, 0, 1));
+
+	// assert
+	EXPECT_NE(copy.aggregator(), node.aggregator());
+	EXPECT_NE(assigned.aggregator(), node.aggregator());
+	EXPECT_EQ(node.aggregator()->count(), 1u);
+	EXPECT_EQ(copy.aggregator()->count(), 2u);
+	EXPECT_EQ(assigned.aggregator()->count(), 1u);
+	EXPECT_EQ(copy.aggregator()->recent().size(), 2u);
+}
+
+TEST(AggregationTests, LongRunShouldKeepBoundedState) {
+	// arrange
+	const std::size_t window = 128;
+	std::vector<entities::Node> nodes(64);
+	auto receiver = entities::Node();
+	receiver.setAggregator(std::make_shared<aggregation::ReceiveAggregator>(window, 0.01));
+	std::vector<entities::Message> messages;
+	for (const auto& node : nodes) {
+		for (auto power = 0; power < 31; power += 2) {
+			messages.push_back(delivered(node, receiver, 100, 0.0, std::ldexp(1e-9, power)));
+		}
+	}
+	const auto& aggregator = *receiver.aggregator();
+	std::size_t buckets = 0;
+
+	// act
+	// assert
+	// latencies span nine decimal orders, after one pass over them nothing the aggregator holds may grow any more
+	for (auto i = 0; i < 1000000; i++) {
+		receiver.receive(messages[i % messages.size()]);
+
+		if (i + 1 == static_cast<int>(messages.size())) {
+			buckets = aggregator.latency().bucketCount();
+		}
+
+		if ((i + 1) % 100000 == 0) {
+			ASSERT_LE(aggregator.recent().size(), window);
+			ASSERT_EQ(aggregator.senderCount(), nodes.size());
+			ASSERT_EQ(aggregator.latency().bucketCount(), buckets);
+		}
+	}
+
+	EXPECT_EQ(aggregator.count(), 1000000u);
+	EXPECT_EQ(aggregator.recent().size(), window);
+	EXPECT_LT(buckets, 2048u);
+	EXPECT_EQ(receiver.receivedCount(), 0);
+}
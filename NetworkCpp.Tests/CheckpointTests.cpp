@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "aggregation.h"
+#include "checkpoint.h"
+#include "forwarding.h"
+#include "generators.h"
+
+class CheckpointTests : public testing::Test {
+};
+
+namespace {
+	std::string snapshotPath(const char* name) {
+		return testing::TempDir() + name;
+	}
+
+	bool exists(const std::string& path) {
+		return std::ifstream(path).good();
+	}
+}
+
+TEST(CheckpointTests, NodesShouldBeRestoredWithMessages) {
+	// arrange
+	auto path = snapshotPath("nodes.snapshot");
+	std::vector<entities::Node> nodes(3);
+	auto foreign = entities::Node();
+
+	auto timed = entities::Message(10, nodes[0], nodes[1]);
+	timed.setSentAt(2.5);
+	timed.setReceivedAt(3.0);
+
+	nodes[0].buffer().add(timed);
+	nodes[0].buffer().add(entities::Message(20, nodes[0], foreign));
+	nodes[2].receivedMessages().add(entities::Message(30, nodes[1], nodes[2]));
+	nodes[1].setIsUnactive(true);
+	auto compact = std::vector<entities::Node>(1);
+	compact[0].setIsCompact(true);
+	compact[0].send(entities::Message(40, compact[0], nodes[0]));
+
+	// act
+	checkpoint::SnapshotWriter(path).write(nodes, {});
+	auto result = checkpoint::Snapshot(path).nodes();
+	checkpoint::SnapshotWriter(path).write(compact, {});
+	auto restoredCompact = checkpoint::Snapshot(path).nodes();
+
+	// assert
+	ASSERT_EQ(result.size(), 3u);
+	for (auto i = 0; i < 3; i++) {
+		EXPECT_EQ(result[i].id(), nodes[i].id());
+		EXPECT_EQ(result[i].isUnactive(), nodes[i].isUnactive());
+		EXPECT_EQ(result[i].buffer().count(), nodes[i].buffer().count());
+		EXPECT_EQ(result[i].receivedMessages().count(), nodes[i].receivedMessages().count());
+	}
+
+	EXPECT_EQ(result[0].buffer()[0], nodes[0].buffer()[0]);
+	EXPECT_EQ(result[0].buffer()[0].size(), 10);
+	EXPECT_EQ(result[0].buffer()[0].receiver(), nodes[1]);
+	EXPECT_DOUBLE_EQ(result[0].buffer()[0].sentAt(), 2.5);
+	EXPECT_DOUBLE_EQ(result[0].buffer()[0].receivedAt(), 3.0);
+	EXPECT_EQ(result[0].buffer()[1].receiver(), foreign);
+	EXPECT_EQ(result[2].receivedMessages()[0].sender(), nodes[1]);
+	EXPECT_TRUE(restoredCompact[0].isCompact());
+	EXPECT_EQ(restoredCompact[0].compactBuffer()[0], compact[0].compactBuffer()[0]);
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, PayloadsShouldBeRestored) {
+	// arrange
+	auto path = snapshotPath("payloads.snapshot");
+	std::vector<entities::Node> nodes(2);
+	auto& pool = payload::SlabPool::shared();
+	auto segmented = entities::Message(8, nodes[0], nodes[1]);
+	auto content = payload::Payload(pool.copyOf("head", 4));
+	content.append(pool.copyOf("-tail", 5));
+	segmented.setPayload(content);
+	auto plain = entities::Message(4, nodes[0], nodes[1]);
+	auto large = entities::Message(16, nodes[1], nodes[0]);
+	large.setPayload(payload::Payload(pool.copyOf(std::string(5000, 'x').data(), 5000)));
+	auto channel = entities::OneWayChannel();
+	channel.add(segmented);
+
+	nodes[0].buffer().add(segmented);
+	nodes[0].buffer().add(plain);
+	nodes[1].receivedMessages().add(large);
+
+	// act
+	checkpoint::SnapshotWriter(path).write(nodes, { &channel });
+	auto snapshot = checkpoint::Snapshot(path);
+	auto result = snapshot.nodes();
+	auto restoredChannel = entities::OneWayChannel();
+	snapshot.restore({ &restoredChannel });
+
+	// assert
+	ASSERT_EQ(result[0].bufferedCount(), 2);
+	const auto bytes = result[0].buffer()[0].payload().bytes();
+	EXPECT_EQ(std::string(bytes.begin(), bytes.end()), "head-tail");
+	EXPECT_TRUE(result[0].buffer()[1].payload().isEmpty());
+	EXPECT_EQ(result[1].receivedMessages()[0].payload().bytes(), large.payload().bytes());
+	EXPECT_EQ(restoredChannel.peek().payload().bytes(), segmented.payload().bytes());
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, ChannelStateShouldBeRestored) {
+	// arrange
+	auto path = snapshotPath("channels.snapshot");
+	std::vector<entities::Node> nodes(2);
+	auto busy = entities::OneWayChannel();
+	auto idle = entities::OneWayChannel();
+	auto message = entities::Message(5, nodes[0], nodes[1]);
+
+	busy.setIsBusy(true);
+	busy.add(message);
+
+	auto busyCopy = entities::OneWayChannel();
+	auto idleCopy = entities::OneWayChannel();
+	idleCopy.setIsBusy(true);
+
+	// act
+	checkpoint::SnapshotWriter(path).write(nodes, { &busy, &idle });
+	checkpoint::Snapshot(path).restore({ &busyCopy, &idleCopy });
+
+	// assert
+	EXPECT_TRUE(busyCopy.isBusy());
+	ASSERT_FALSE(busyCopy.isEmpty());
+	EXPECT_EQ(busyCopy.peek(), message);
+	EXPECT_EQ(busyCopy.peek().size(), 5);
+	EXPECT_FALSE(idleCopy.isBusy());
+	EXPECT_TRUE(idleCopy.isEmpty());
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, GeneratorShouldContinueFromSnapshot) {
+	// arrange
+	auto path = snapshotPath("generator.snapshot");
+	std::vector<entities::Node> nodes(4);
+	auto generator = traffic::TrafficGenerator(nodes, std::make_shared<traffic::OnOffArrivals>(10.0, 1.0, 1.0),
+		std::make_shared<traffic::UniformSize>(1, 100), 11);
+	auto restored = traffic::TrafficGenerator(nodes, std::make_shared<traffic::OnOffArrivals>(10.0, 1.0, 1.0),
+		std::make_shared<traffic::UniformSize>(1, 100), 99);
+	std::vector<traffic::Arrival> expected, result;
+
+	generator.generate(expected, 1000);
+	expected.clear();
+
+	// act
+	checkpoint::SnapshotWriter(path).write(nodes, {}, &generator);
+	checkpoint::Snapshot(path).restore(restored);
+
+	generator.generate(expected, 100);
+	restored.generate(result, 100);
+
+	// assert
+	ASSERT_EQ(result.size(), expected.size());
+	for (std::size_t i = 0; i < result.size(); i++) {
+		EXPECT_DOUBLE_EQ(result[i].time, expected[i].time);
+		EXPECT_EQ(result[i].source, expected[i].source);
+		EXPECT_EQ(result[i].destination, expected[i].destination);
+		EXPECT_EQ(result[i].size, expected[i].size);
+	}
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, SnapshotShouldBeWrittenIncrementally) {
+	// arrange
+	auto path = snapshotPath("incremental.snapshot");
+	auto messageGenerator = generators::MessageGenerator();
+	std::vector<entities::Node> nodes(10);
+	for (auto& node : nodes) {
+		node.buffer().add(messageGenerator());
+	}
+
+	std::remove(path.c_str());
+	auto writer = checkpoint::SnapshotWriter(path);
+	auto steps = 0;
+
+	// act
+	writer.begin(nodes, {});
+	while (!writer.step(64)) {
+		EXPECT_FALSE(exists(path));
+		steps++;
+	}
+
+	// assert
+	EXPECT_GT(steps, 1);
+	EXPECT_TRUE(writer.isFinished());
+	EXPECT_EQ(checkpoint::Snapshot(path).nodes()[9].buffer()[0], nodes[9].buffer()[0]);
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, SnapshotShouldKeepStateOfBegin) {
+	// arrange
+	auto path = snapshotPath("frozen.snapshot");
+	auto messageGenerator = generators::MessageGenerator();
+	std::vector<entities::Node> nodes(4);
+	for (auto& node : nodes) {
+		node.buffer().add(messageGenerator());
+	}
+	const auto first = nodes[0].buffer()[0];
+	auto writer = checkpoint::SnapshotWriter(path);
+
+	// act
+	writer.begin(nodes, {});
+	nodes[0].buffer().clear();
+	nodes[1].buffer().add(messageGenerator());
+	nodes[2].setIsUnactive(true);
+	while (!writer.step(32)) {
+	}
+	auto restored = checkpoint::Snapshot(path).nodes();
+
+	// assert
+	ASSERT_EQ(restored[0].bufferedCount(), 1);
+	EXPECT_EQ(restored[0].buffer()[0], first);
+	EXPECT_EQ(restored[1].bufferedCount(), 1);
+	EXPECT_FALSE(restored[2].isUnactive());
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, PreviousSnapshotShouldStayUntilReplaced) {
+	// arrange
+	auto path = snapshotPath("replaced.snapshot");
+	std::vector<entities::Node> before(2);
+	std::vector<entities::Node> after(3);
+	checkpoint::SnapshotWriter(path).write(before, {});
+	auto writer = checkpoint::SnapshotWriter(path);
+
+	// act
+	writer.begin(after, {});
+	writer.step(16);
+	const auto pending = checkpoint::Snapshot(path).nodeCount();
+	while (!writer.step(16)) {
+	}
+
+	// assert
+	EXPECT_EQ(pending, 2u);
+	EXPECT_EQ(checkpoint::Snapshot(path).nodeCount(), 3u);
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, AggregatingNodesShouldBeRejected) {
+	// arrange
+	auto path = snapshotPath("aggregated.snapshot");
+	std::vector<entities::Node> nodes(2);
+	checkpoint::SnapshotWriter(path).write(nodes, {});
+	nodes[1].setAggregator(std::make_shared<aggregation::ReceiveAggregator>());
+	auto writer = checkpoint::SnapshotWriter(path);
+
+	// act
+	// assert
+	EXPECT_THROW(writer.write(nodes, {}), std::invalid_argument);
+	EXPECT_TRUE(writer.isFinished());
+	EXPECT_EQ(checkpoint::Snapshot(path).nodeCount(), 2u);
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, EngineShouldResumeMidFlight) {
+	// arrange
+	auto path = snapshotPath("engine.snapshot");
+	std::vector<topology::Link> links;
+	for (std::uint32_t i = 0; i + 1 < 5; i++) {
+		links.push_back({ i, i + 1 });
+		links.push_back({ i + 1, i });
+	}
+	auto graph = std::make_shared<topology::Graph>(5, links);
+
+	std::vector<entities::Node> nodes(5);
+	auto engine = forwarding::ForwardingEngine(nodes, std::make_shared<routing::RoutingTable>(graph), 1.0, 1, 3);
+	for (auto i = 0; i < 6; i++) {
+		nodes[0].buffer().add(entities::Message(i + 1, nodes[0], nodes[4]));
+		nodes[4].buffer().add(entities::Message(i + 1, nodes[4], nodes[1]));
+	}
+	engine.step();
+	engine.step();
+
+	// act
+	checkpoint::SnapshotWriter(path).write(nodes, {}, nullptr, &engine);
+	auto snapshot = checkpoint::Snapshot(path);
+	auto restoredNodes = snapshot.nodes();
+	auto restored = forwarding::ForwardingEngine(restoredNodes, std::make_shared<routing::RoutingTable>(graph), 1.0, 1, 3);
+	snapshot.restore(restored);
+	const auto expectedInFlight = engine.inFlight();
+	const auto inFlight = restored.inFlight();
+
+	engine.run(100);
+	restored.run(100);
+
+	// assert
+	EXPECT_TRUE(snapshot.hasEngine());
+	EXPECT_GT(inFlight, 0u);
+	EXPECT_EQ(inFlight, expectedInFlight);
+	EXPECT_DOUBLE_EQ(restored.time(), engine.time());
+	EXPECT_EQ(restored.delivered(), engine.delivered());
+	EXPECT_EQ(restored.forwarded(), engine.forwarded());
+	EXPECT_EQ(restored.dropped(), engine.dropped());
+	EXPECT_GT(engine.dropped(), 0u);
+	for (auto i = 0; i < 5; i++) {
+		ASSERT_EQ(restoredNodes[i].receivedCount(), nodes[i].receivedCount());
+		for (auto j = 0; j < nodes[i].receivedCount(); j++) {
+			EXPECT_EQ(restoredNodes[i].receivedMessages()[j], nodes[i].receivedMessages()[j]);
+			EXPECT_DOUBLE_EQ(restoredNodes[i].receivedMessages()[j].receivedAt(), nodes[i].receivedMessages()[j].receivedAt());
+		}
+	}
+
+	std::remove(path.c_str());
+}
+
+TEST(CheckpointTests, SnapshotShouldRejectForeignFiles) {
+	// arrange
+	auto path = snapshotPath("foreign.snapshot");
+	std::ofstream(path) << "definitely not a snapshot, but long enough to have a header";
+
+	// act
+	// assert
+	EXPECT_THROW(checkpoint::Snapshot{ path }, std::runtime_error);
+
+	std::remove(path.c_str());
+}
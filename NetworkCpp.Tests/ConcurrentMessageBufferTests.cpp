@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent.h"
+#include "generators.h"
+
+class ConcurrentMessageBufferTests : public testing::Test {
+};
+
+namespace {
+	const int			itemsPerProducer = 100000;
+
+	template<typename Queue>
+	void produce(Queue& queue, const int producer, const bool batched) {
+		const auto first = producer * itemsPerProducer;
+		std::vector<int> batch(32);
+
+		for (auto next = first; next < first + itemsPerProducer;) {
+			if (!batched) {
+				if (queue.tryAdd(next)) {
+					next++;
+				}
+				else {
+					std::this_thread::yield();
+				}
+				continue;
+			}
+
+			const auto length = std::min<std::size_t>(batch.size(), first + itemsPerProducer - next);
+			for (std::size_t i = 0; i < length; i++) {
+				batch[i] = next + static_cast<int>(i);
+			}
+
+			const auto added = queue.addBatch(batch.data(), length);
+			next += static_cast<int>(added);
+			if (added == 0) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	template<typename Queue>
+	void consume(Queue& queue, std::atomic<int>& remaining, std::vector<std::atomic<int>>& seen) {
+		int batch[32];
+
+		while (remaining.load() > 0) {
+			const auto taken = queue.takeBatch(batch, 32);
+			for (std::size_t i = 0; i < taken; i++) {
+				seen[batch[i]]++;
+			}
+
+			remaining -= static_cast<int>(taken);
+			if (taken == 0) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void stress(const int producers, const int consumers, const bool batched) {
+		auto queue = std::make_shared<concurrent::BoundedQueue<int, 4096>>();
+		std::vector<std::atomic<int>> seen(producers * itemsPerProducer);
+		std::atomic<int> remaining(producers * itemsPerProducer);
+		std::vector<std::thread> threads;
+
+		for (auto& counter : seen) {
+			counter = 0;
+		}
+
+		const auto started = std::chrono::steady_clock::now();
+
+		for (auto i = 0; i < producers; i++) {
+			threads.emplace_back([&queue, i, batched]() { produce(*queue, i, batched); });
+		}
+
+		for (auto i = 0; i < consumers; i++) {
+			threads.emplace_back([&queue, &remaining, &seen]() { consume(*queue, remaining, seen); });
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		testing::Test::RecordProperty("producers" + std::to_string(producers) + (batched ? "Batched" : "Single") + "OpsPerSecond",
+			std::to_string(static_cast<long long>(producers * itemsPerProducer / seconds)));
+
+		for (auto& counter : seen) {
+			ASSERT_EQ(counter.load(), 1);
+		}
+		EXPECT_TRUE(queue->isEmpty());
+	}
+}
+
+TEST(ConcurrentMessageBufferTests, CapacityShouldBeRoundedToPowerOfTwo) {
+	// arrange
+	// act
+	// assert
+	EXPECT_EQ((concurrent::BoundedQueue<int, 1>::capacity), 1u);
+	EXPECT_EQ((concurrent::BoundedQueue<int, 5>::capacity), 8u);
+	EXPECT_EQ((concurrent::BoundedQueue<int, 1024>::capacity), 1024u);
+}
+
+TEST(ConcurrentMessageBufferTests, BufferShouldBeLimited) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	concurrent::ConcurrentMessageBuffer<2> buffer;
+	auto first = messageGenerator();
+	auto second = messageGenerator();
+
+	// act
+	auto results = { buffer.tryAdd(first), buffer.tryAdd(second), buffer.tryAdd(messageGenerator()) };
+
+	// assert
+	EXPECT_EQ(std::vector<bool>(results), std::vector<bool>({ true, true, false }));
+	EXPECT_TRUE(buffer.isFilled());
+	EXPECT_EQ(buffer.count(), 2u);
+}
+
+TEST(ConcurrentMessageBufferTests, MessagesShouldBeTakenInOrder) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	concurrent::ConcurrentMessageBuffer<4> buffer;
+	auto first = messageGenerator();
+	auto second = messageGenerator();
+	auto result = messageGenerator();
+
+	buffer.tryAdd(first);
+	buffer.tryAdd(second);
+
+	// act
+	// assert
+	ASSERT_TRUE(buffer.tryTake(result));
+	EXPECT_EQ(result, first);
+	ASSERT_TRUE(buffer.tryTake(result));
+	EXPECT_EQ(result, second);
+	EXPECT_FALSE(buffer.tryTake(result));
+	EXPECT_TRUE(buffer.isEmpty());
+}
+
+TEST(ConcurrentMessageBufferTests, BatchesShouldBeLimitedByFreeSpace) {
+	// arrange
+	concurrent::BoundedQueue<int, 8> buffer;
+	int items[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	int taken[10];
+
+	// act
+	auto added = buffer.addBatch(items, 10);
+	auto takenCount = buffer.takeBatch(taken, 3);
+	auto addedAgain = buffer.addBatch(items, 10);
+
+	// assert
+	EXPECT_EQ(added, 8u);
+	EXPECT_EQ(takenCount, 3u);
+	EXPECT_EQ(taken[2], 2);
+	EXPECT_EQ(addedAgain, 3u);
+	EXPECT_EQ(buffer.count(), 8u);
+}
+
+TEST(ConcurrentMessageBufferTests, MessagesShouldSurviveConcurrentTransfer) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto buffer = std::make_shared<concurrent::ConcurrentMessageBuffer<64>>();
+	std::vector<entities::Message> messages;
+	for (auto i = 0; i < 2000; i++) {
+		messages.push_back(messageGenerator());
+	}
+	std::vector<entities::Message> received;
+
+	// act
+	auto producer = std::thread([&]() {
+		for (const auto& message : messages) {
+			while (!buffer->tryAdd(message)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	auto message = messageGenerator();
+	while (received.size() < messages.size()) {
+		if (buffer->tryTake(message)) {
+			received.push_back(message);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	// assert
+	for (std::size_t i = 0; i < messages.size(); i++) {
+		EXPECT_EQ(received[i], messages[i]);
+	}
+}
+
+TEST(ConcurrentMessageBufferTests, ItemsShouldBeDeliveredOnceFromManyProducers) {
+	// arrange
+	// act
+	// assert
+	for (auto producers = 1; producers <= 8; producers *= 2) {
+		stress(producers, 2, false);
+	}
+}
+
+TEST(ConcurrentMessageBufferTests, BatchedItemsShouldBeDeliveredOnceFromManyProducers) {
+	// arrange
+	// act
+	// assert
+	for (auto producers = 1; producers <= 8; producers *= 2) {
+		stress(producers, 2, true);
+	}
+}
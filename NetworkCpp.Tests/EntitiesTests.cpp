@@ -51,12 +51,11 @@ TEST(EntitiesTests, CopiedMessageShouldContaintSameSenderAndReceiver) {
 	// act
 	auto result = entities::Message(message);
 
-	result.sender().buffer().add(messageGenerator());
-	result.receiver().buffer().add(messageGenerator());
-
 	// assert
-	EXPECT_EQ(result.sender().buffer().count(), message.sender().buffer().count());
-	EXPECT_EQ(result.receiver().buffer().count(), message.receiver().buffer().count());
+	EXPECT_EQ(result.sender(), message.sender());
+	EXPECT_EQ(result.receiver(), message.receiver());
+	EXPECT_EQ(&result.sender(), &message.sender());
+	EXPECT_EQ(&result.receiver(), &message.receiver());
 }
 
 TEST(EntitiesTests, NodeShouldBeCreatedWithCorrectInfo) {
@@ -113,4 +112,82 @@ TEST(EntitiesTest, NodeShouldBeCopiedIndependently) {
 	EXPECT_NE(result.receivedMessages().count(), node.receivedMessages().count());
 	EXPECT_NE(result.isUnactive(), node.isUnactive());
 	EXPECT_EQ(result.id(), node.id());
-}
\ No newline at end of file
+}
+
+TEST(EntitiesTests, IdleNodeShouldStayCompact) {
+	// arrange
+	std::vector<entities::Node> nodes(1000);
+
+	// act
+	auto copies = nodes;
+
+	// assert
+	EXPECT_LE(sizeof(entities::Node), 64u);
+	EXPECT_EQ(copies[0].bufferedCount(), 0);
+	EXPECT_EQ(copies[0].receivedCount(), 0);
+	EXPECT_EQ(copies[0], nodes[0]);
+}
+
+TEST(EntitiesTests, NodeBuffersShouldBeAllocatedOnFirstUse) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto node = entities::Node();
+
+	// act
+	node.buffer().add(messageGenerator());
+	auto result = entities::Node(node);
+
+	// assert
+	EXPECT_EQ(node.bufferedCount(), 1);
+	EXPECT_EQ(node.receivedCount(), 0);
+	EXPECT_EQ(result.bufferedCount(), 1);
+	EXPECT_EQ(result.receivedCount(), 0);
+	EXPECT_EQ(result.buffer()[0], node.buffer()[0]);
+}
+
+TEST(EntitiesTests, CompactBuffersShouldBeOptIn) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto observed = entities::Node();
+	auto compact = entities::Node();
+
+	// act
+	entities::MessageBuffer<>& buffer = observed.buffer();
+	buffer.add(messageGenerator());
+	compact.setIsCompact(true);
+	compact.send(messageGenerator());
+	compact.receive(messageGenerator());
+	auto copy = entities::Node(compact);
+
+	// assert
+	EXPECT_FALSE(observed.isCompact());
+	EXPECT_EQ(observed.bufferedCount(), 1);
+	EXPECT_THROW(observed.compactBuffer(), std::logic_error);
+	EXPECT_LT(sizeof(entities::NodeBuffer), sizeof(entities::MessageBuffer<>));
+	EXPECT_EQ(compact.bufferedCount(), 1);
+	EXPECT_EQ(compact.receivedCount(), 1);
+	EXPECT_THROW(compact.buffer(), std::logic_error);
+	EXPECT_THROW(compact.setIsCompact(false), std::logic_error);
+	EXPECT_TRUE(copy.isCompact());
+	EXPECT_EQ(copy.compactBuffer()[0], compact.compactBuffer()[0]);
+}
+
+TEST(EntitiesTests, MessageShouldNotCopyEndpointBuffers) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto sender = entities::Node();
+	auto receiver = entities::Node();
+	for (auto i = 0; i < 100; i++) {
+		sender.buffer().add(messageGenerator());
+		receiver.receivedMessages().add(messageGenerator());
+	}
+
+	// act
+	auto result = entities::Message(8, sender, receiver);
+
+	// assert
+	EXPECT_EQ(result.sender(), sender);
+	EXPECT_EQ(result.receiver(), receiver);
+	EXPECT_EQ(result.sender().bufferedCount(), 0);
+	EXPECT_EQ(result.receiver().receivedCount(), 0);
+}
@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include "failures.h"
+#include "forwarding.h"
+
+class FailuresTests : public testing::Test {
+};
+
+namespace {
+	std::shared_ptr<topology::Graph> grid(const std::uint32_t side) {
+		std::vector<topology::Link> links;
+		for (std::uint32_t row = 0; row < side; row++) {
+			for (std::uint32_t column = 0; column < side; column++) {
+				const auto node = row * side + column;
+				if (column + 1 < side) {
+					links.push_back({ node, node + 1 });
+					links.push_back({ node + 1, node });
+				}
+				if (row + 1 < side) {
+					links.push_back({ node, node + side });
+					links.push_back({ node + side, node });
+				}
+			}
+		}
+
+		return std::make_shared<topology::Graph>(side * side, links);
+	}
+
+	std::shared_ptr<topology::Graph> ring(const std::uint32_t nodeCount) {
+		std::vector<topology::Link> links;
+		for (std::uint32_t i = 0; i < nodeCount; i++) {
+			links.push_back({ i, (i + 1) % nodeCount });
+			links.push_back({ (i + 1) % nodeCount, i });
+		}
+
+		return std::make_shared<topology::Graph>(nodeCount, links);
+	}
+
+	void expectSameRoutes(routing::RoutingTable& repaired, const std::vector<std::uint32_t>& destinations) {
+		const auto& graph = repaired.graph();
+		auto rebuilt = routing::RoutingTable(std::make_shared<topology::Graph>(graph));
+		std::vector<std::uint32_t> downLinks;
+		std::vector<std::uint32_t> downNodes;
+		for (std::uint32_t link = 0; link < graph.linkCount(); link++) {
+			if (!repaired.isLinkUp(link)) {
+				downLinks.push_back(link);
+			}
+		}
+		for (std::uint32_t node = 0; node < graph.nodeCount(); node++) {
+			if (!repaired.isNodeUp(node)) {
+				downNodes.push_back(node);
+			}
+		}
+		rebuilt.setLinksUp(downLinks, false);
+		rebuilt.setNodesUp(downNodes, false);
+
+		for (auto destination : destinations) {
+			for (std::uint32_t node = 0; node < graph.nodeCount(); node++) {
+				ASSERT_EQ(repaired.distance(node, destination), rebuilt.distance(node, destination));
+
+				// any next hop is fine as long as it is usable and one step closer
+				const auto next = repaired.nextLink(node, destination);
+				if (next != topology::Graph::none) {
+					ASSERT_TRUE(repaired.isUsable(next));
+					ASSERT_EQ(repaired.distance(graph.link(next).target, destination) + 1, repaired.distance(node, destination));
+				}
+			}
+		}
+	}
+}
+
+TEST(FailuresTests, FailedLinkShouldBeRoutedAround) {
+	// arrange
+	auto routes = routing::RoutingTable(ring(6));
+	const auto before = routes.distance(0, 2);
+
+	// act
+	routes.setLinksUp({ routes.graph().find(1, 2), routes.graph().find(2, 1) }, false);
+	const auto during = routes.distance(0, 2);
+	routes.setLinkUp(routes.graph().find(1, 2), true);
+	routes.setLinkUp(routes.graph().find(2, 1), true);
+
+	// assert
+	EXPECT_EQ(before, 2u);
+	EXPECT_EQ(during, 4u);
+	EXPECT_EQ(routes.distance(0, 2), 2u);
+	EXPECT_EQ(routes.graph().link(routes.nextLink(0, 2)).target, 1u);
+}
+
+TEST(FailuresTests, FailedNodeShouldBeUnreachable) {
+	// arrange
+	auto routes = routing::RoutingTable(ring(6));
+	routes.distance(0, 3);
+
+	// act
+	routes.setNodeUp(3, false);
+
+	// assert
+	EXPECT_EQ(routes.distance(0, 3), topology::Graph::none);
+	EXPECT_EQ(routes.distance(2, 4), 4u);
+	EXPECT_EQ(routes.distance(3, 4), topology::Graph::none);
+	routes.setNodeUp(3, true);
+	EXPECT_EQ(routes.distance(0, 3), 3u);
+	EXPECT_EQ(routes.distance(2, 4), 2u);
+}
+
+TEST(FailuresTests, RepairedRoutesShouldMatchRebuiltRoutes) {
+	// arrange
+	auto routes = routing::RoutingTable(grid(12));
+	boost::random::mt19937 random(42);
+	boost::random::uniform_int_distribution<std::uint32_t> links(0, routes.graph().linkCount() - 1);
+	boost::random::uniform_int_distribution<std::uint32_t> nodes(0, routes.graph().nodeCount() - 1);
+	const std::vector<std::uint32_t> destinations = { 0, 17, 77, 143 };
+	for (auto destination : destinations) {
+		routes.distance(0, destination);
+	}
+
+	// act
+	// assert
+	for (auto round = 0; round < 30; round++) {
+		std::vector<std::uint32_t> batch;
+		for (auto i = 0; i < 5; i++) {
+			batch.push_back(links(random));
+		}
+		routes.setLinksUp(batch, round % 3 == 2);
+		routes.setNodeUp(nodes(random), round % 4 == 3);
+
+		expectSameRoutes(routes, destinations);
+	}
+}
+
+TEST(FailuresTests, ScheduleShouldApplyDueEventsInBulk) {
+	// arrange
+	std::vector<entities::Node> nodes(6);
+	auto routes = std::make_shared<routing::RoutingTable>(ring(6));
+	auto schedule = failures::FailureSchedule(nodes, routes);
+	schedule.failNodes(2.0, { 1, 4 }, 3.0);
+	schedule.add(failures::Event{ 1.0, failures::Target::Link, routes->graph().find(0, 5), false });
+
+	// act
+	const auto first = schedule.apply(1.5);
+	const auto second = schedule.apply(2.0);
+
+	// assert
+	EXPECT_EQ(first, 1u);
+	EXPECT_EQ(second, 2u);
+	EXPECT_TRUE(nodes[4].isUnactive());
+	EXPECT_FALSE(routes->isNodeUp(1));
+	EXPECT_FALSE(routes->isLinkUp(routes->graph().find(0, 5)));
+	EXPECT_EQ(schedule.pending(), 2u);
+	EXPECT_DOUBLE_EQ(schedule.nextTime(), 5.0);
+	EXPECT_EQ(schedule.apply(10.0), 2u);
+	EXPECT_FALSE(nodes[1].isUnactive());
+	EXPECT_TRUE(routes->isNodeUp(4));
+}
+
+TEST(FailuresTests, NodePairsShouldFailBothDirections) {
+	// arrange
+	std::vector<entities::Node> nodes(6);
+	auto routes = std::make_shared<routing::RoutingTable>(ring(6));
+	auto schedule = failures::FailureSchedule(nodes, routes);
+	entities::OneWayChannel channel;
+	entities::Node stranger;
+	const auto& graph = routes->graph();
+	schedule.failLinks(1.0, entities::NodesPair(nodes[1], nodes[2], channel), 2.0);
+	schedule.failLinks(1.0, entities::NodesPair(nodes[4], nodes[3], channel));
+
+	// act
+	const auto applied = schedule.apply(1.0);
+	const auto forward = routes->distance(1, 2);
+	const auto backward = routes->distance(2, 1);
+	const auto restored = schedule.apply(3.0);
+
+	// assert
+	EXPECT_EQ(applied, 4u);
+	EXPECT_EQ(forward, topology::Graph::none);
+	EXPECT_EQ(backward, topology::Graph::none);
+	EXPECT_EQ(restored, 2u);
+	EXPECT_TRUE(routes->isLinkUp(graph.find(1, 2)));
+	EXPECT_TRUE(routes->isLinkUp(graph.find(2, 1)));
+	EXPECT_FALSE(routes->isLinkUp(graph.find(3, 4)));
+	EXPECT_FALSE(routes->isLinkUp(graph.find(4, 3)));
+	EXPECT_THROW(schedule.failLinks(4.0, entities::NodesPair(nodes[0], nodes[3], channel)), std::invalid_argument);
+	EXPECT_THROW(schedule.failLinks(4.0, entities::NodesPair(nodes[0], stranger, channel)), std::invalid_argument);
+	EXPECT_EQ(schedule.pending(), 0u);
+}
+
+TEST(FailuresTests, StrandedMessagesShouldBeRequeued) {
+	// arrange
+	std::vector<entities::Node> nodes(6);
+	auto routes = std::make_shared<routing::RoutingTable>(ring(6));
+	auto engine = forwarding::ForwardingEngine(nodes, routes);
+	auto schedule = failures::FailureSchedule(nodes, routes);
+	for (auto i = 0; i < 4; i++) {
+		nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	}
+	schedule.failLinks(1.0, { routes->graph().find(0, 1) });
+
+	// act
+	for (auto i = 0; i < 20 && (i < 2 || !engine.isIdle()); i++) {
+		schedule.apply(engine.time());
+		engine.step();
+	}
+
+	// assert
+	EXPECT_EQ(engine.rerouted(), 3u);
+	EXPECT_EQ(engine.delivered(), 4u);
+	EXPECT_EQ(nodes[2].receivedMessages().count(), 4);
+}
+
+TEST(FailuresTests, FailedNodeShouldHoldOutboundAndLoseTransit) {
+	// arrange
+	std::vector<entities::Node> nodes(4);
+	auto routes = std::make_shared<routing::RoutingTable>(
+		std::make_shared<topology::Graph>(4, std::vector<topology::Link>({ { 0, 1 }, { 1, 2 }, { 2, 3 } })));
+	auto engine = forwarding::ForwardingEngine(nodes, routes);
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[3]));
+	nodes[2].buffer().add(entities::Message(1, nodes[2], nodes[3]));
+	engine.step();
+
+	// act
+	routes->setNodesUp({ 1, 2 }, false);
+	nodes[2].buffer().add(entities::Message(1, nodes[2], nodes[3]));
+	engine.run(10);
+
+	// assert
+	EXPECT_EQ(engine.dropped(), 1u);
+	EXPECT_EQ(engine.delivered(), 1u);
+	EXPECT_EQ(nodes[2].buffer().count(), 1);
+}
+
+TEST(FailuresTests, UnactiveFlagShouldDriveRouting) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto routes = std::make_shared<routing::RoutingTable>(
+		std::make_shared<topology::Graph>(3, std::vector<topology::Link>({ { 0, 1 }, { 1, 2 } })));
+	auto engine = forwarding::ForwardingEngine(nodes, routes);
+	nodes[1].setIsUnactive(true);
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+
+	// act
+	engine.run(10);
+	const auto isDown = !routes->isNodeUp(1);
+	nodes[1].setIsUnactive(false);
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	engine.run(10);
+
+	// assert
+	EXPECT_TRUE(isDown);
+	EXPECT_TRUE(routes->isNodeUp(1));
+	EXPECT_EQ(engine.unroutable(), 1u);
+	EXPECT_EQ(engine.delivered(), 1u);
+}
+
+TEST(FailuresTests, ThrowingBatchShouldStayPending) {
+	// arrange
+	std::vector<entities::Node> nodes(4);
+	auto routes = std::make_shared<routing::RoutingTable>(ring(4));
+	auto schedule = failures::FailureSchedule(nodes, routes);
+	schedule.failNodes(1.0, { 1, 9 });
+
+	// act
+	// assert
+	EXPECT_THROW(schedule.apply(2.0), std::out_of_range);
+	EXPECT_EQ(schedule.pending(), 2u);
+	EXPECT_DOUBLE_EQ(schedule.nextTime(), 1.0);
+}
+
+TEST(FailuresTests, SingleFailureShouldBeRepairedIncrementally) {
+	// arrange
+	const std::uint32_t side = 317;
+	auto routes = routing::RoutingTable(grid(side));
+	const std::vector<std::uint32_t> destinations = { 0, side * side - 1, side * side / 2 + 3, side / 2 };
+	for (auto destination : destinations) {
+		routes.distance(0, destination);
+	}
+
+	// act
+	routes.setNodeUp(side * side / 2, false);
+
+	// assert
+	// every cached tree is repaired in place, and together they rewrite fewer entries than one rebuilt tree holds
+	EXPECT_EQ(routes.treeCount(), destinations.size());
+	EXPECT_GT(routes.rewritten(), 0u);
+	EXPECT_LT(routes.rewritten(), std::uint64_t(side) * side);
+	expectSameRoutes(routes, destinations);
+}
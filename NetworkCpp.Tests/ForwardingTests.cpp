@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "forwarding.h"
+
+class ForwardingTests : public testing::Test {
+};
+
+namespace {
+	std::shared_ptr<routing::RoutingTable> line(const std::uint32_t nodeCount) {
+		std::vector<topology::Link> links;
+		for (std::uint32_t i = 0; i + 1 < nodeCount; i++) {
+			links.push_back({ i, i + 1 });
+			links.push_back({ i + 1, i });
+		}
+
+		return std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(nodeCount, links));
+	}
+}
+
+TEST(ForwardingTests, MessageShouldTravelOneHopPerStep) {
+	// arrange
+	std::vector<entities::Node> nodes(4);
+	auto engine = forwarding::ForwardingEngine(nodes, line(4), 0.5);
+	auto message = entities::Message(8, nodes[0], nodes[3]);
+	nodes[0].buffer().add(message);
+
+	// act
+	const auto steps = engine.run(100);
+
+	// assert
+	EXPECT_EQ(steps, 4u);
+	EXPECT_EQ(nodes[0].buffer().count(), 0);
+	ASSERT_EQ(nodes[3].receivedMessages().count(), 1);
+	EXPECT_EQ(nodes[3].receivedMessages()[0], message);
+	EXPECT_DOUBLE_EQ(nodes[3].receivedMessages()[0].receivedAt(), 1.5);
+	EXPECT_EQ(engine.forwarded(), 3u);
+	EXPECT_EQ(engine.delivered(), 1u);
+	EXPECT_TRUE(engine.isIdle());
+}
+
+TEST(ForwardingTests, CompactNodesShouldForwardAndReceive) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	for (auto& node : nodes) {
+		node.setIsCompact(true);
+	}
+	auto engine = forwarding::ForwardingEngine(nodes, line(3));
+	nodes[0].send(entities::Message(8, nodes[0], nodes[2]));
+	nodes[2].send(entities::Message(8, nodes[2], nodes[0]));
+
+	// act
+	engine.run(100);
+
+	// assert
+	EXPECT_EQ(engine.delivered(), 2u);
+	EXPECT_EQ(nodes[0].bufferedCount(), 0);
+	EXPECT_EQ(nodes[0].compactReceivedMessages().count(), 1);
+	EXPECT_EQ(nodes[2].compactReceivedMessages().count(), 1);
+}
+
+TEST(ForwardingTests, RunShouldNotStepWhenIdleOrLimitedToZero) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	auto engine = forwarding::ForwardingEngine(nodes, line(2));
+
+	// act
+	const auto idleSteps = engine.run(100);
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[1]));
+	const auto limitedSteps = engine.run(0);
+	const auto isIdle = engine.isIdle();
+
+	// assert
+	EXPECT_EQ(idleSteps, 0u);
+	EXPECT_EQ(limitedSteps, 0u);
+	EXPECT_FALSE(isIdle);
+	EXPECT_DOUBLE_EQ(engine.time(), 0.0);
+	EXPECT_EQ(nodes[0].buffer().count(), 1);
+}
+
+TEST(ForwardingTests, RecorderShouldSeeHopsAndDeliveries) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto routes = line(3);
+	auto engine = forwarding::ForwardingEngine(nodes, routes, 1.0, 1);
+	auto recorder = std::make_shared<metrics::LatencyRecorder>(1.0);
+	engine.setRecorder(recorder);
+	for (auto i = 0; i < 3; i++) {
+		nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	}
+
+	// act
+	engine.run(100);
+
+	// assert
+	const auto first = recorder->link(routes->graph().find(0, 1));
+	const auto second = recorder->link(routes->graph().find(1, 2));
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_EQ(first->count(), 3u);
+	EXPECT_EQ(first->max(), 3u);
+	EXPECT_EQ(second->count(), 3u);
+	EXPECT_EQ(second->max(), 1u);
+	EXPECT_EQ(recorder->link(routes->graph().find(1, 0)), nullptr);
+	EXPECT_EQ(recorder->global().count(), 3u);
+	EXPECT_EQ(recorder->global().min(), 2u);
+	EXPECT_EQ(recorder->global().max(), 4u);
+	EXPECT_EQ(recorder->pair(nodes[0].id(), nodes[2].id())->count(), 3u);
+}
+
+TEST(ForwardingTests, LinkCapacityShouldLimitThroughput) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	auto engine = forwarding::ForwardingEngine(nodes, line(2), 1.0, 2);
+	for (auto i = 0; i < 5; i++) {
+		nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[1]));
+	}
+
+	// act
+	engine.step();
+	const auto queued = engine.queued(0);
+	engine.step();
+	const auto delivered = engine.delivered();
+	engine.run(100);
+
+	// assert
+	EXPECT_EQ(queued, 3u);
+	EXPECT_EQ(delivered, 2u);
+	EXPECT_EQ(engine.delivered(), 5u);
+	EXPECT_DOUBLE_EQ(nodes[1].receivedMessages()[4].receivedAt(), 3.0);
+}
+
+TEST(ForwardingTests, FullQueueShouldDropMessages) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	auto engine = forwarding::ForwardingEngine(nodes, line(2), 1.0, 1, 2);
+	for (auto i = 0; i < 3; i++) {
+		nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[1]));
+	}
+
+	// act
+	engine.run(100);
+
+	// assert
+	EXPECT_EQ(engine.dropped(), 1u);
+	EXPECT_EQ(engine.delivered(), 2u);
+	EXPECT_EQ(nodes[1].receivedMessages().count(), 2);
+}
+
+TEST(ForwardingTests, UnreachableDestinationShouldBeCounted) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto routes = std::make_shared<routing::RoutingTable>(
+		std::make_shared<topology::Graph>(3, std::vector<topology::Link>({ { 0, 1 }, { 1, 0 } })));
+	auto engine = forwarding::ForwardingEngine(nodes, routes);
+	entities::Node stranger;
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	nodes[0].buffer().add(entities::Message(1, nodes[0], stranger));
+
+	// act
+	engine.run(100);
+
+	// assert
+	EXPECT_EQ(engine.unroutable(), 2u);
+	EXPECT_EQ(engine.delivered(), 0u);
+	EXPECT_TRUE(engine.isIdle());
+}
+
+TEST(ForwardingTests, CrossTrafficShouldAllBeDelivered) {
+	// arrange
+	const std::uint32_t nodeCount = 16;
+	std::vector<entities::Node> nodes(nodeCount);
+	auto engine = forwarding::ForwardingEngine(nodes, line(nodeCount), 1.0, 4);
+	for (std::uint32_t source = 0; source < nodeCount; source++) {
+		for (std::uint32_t destination = 0; destination < nodeCount; destination++) {
+			nodes[source].buffer().add(entities::Message(1, nodes[source], nodes[destination]));
+		}
+	}
+
+	// act
+	engine.run(1000);
+
+	// assert
+	EXPECT_EQ(engine.delivered(), nodeCount * nodeCount);
+	for (auto& node : nodes) {
+		EXPECT_EQ(node.receivedMessages().count(), static_cast<int>(nodeCount));
+	}
+}
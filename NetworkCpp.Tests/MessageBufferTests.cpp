@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "entities.h"
 #include "generators.h"
 
@@ -9,6 +11,47 @@ entities::Message testMessages[] = { messageGenerator(), messageGenerator(), mes
 class MessageBufferTests : public testing::Test {
 };
 
+namespace {
+	// records what a buffer reports, registered directly on the buffer under test
+	class RecordingObserver : public entities::MessageContainerObserver {
+	public:
+		explicit RecordingObserver(entities::Observable& observable)
+			: MessageContainerObserver(observable), added(0), removed(0), cleared(0), sender(nullptr), m_target(observable) {
+			m_target.addObserver(this);
+		}
+
+		~RecordingObserver() override {
+			m_target.removeObserver(this);
+		}
+
+		void addListener(void* source, const entities::Message& message) override {
+			added++;
+			sender = source;
+			messages.push_back(message);
+		}
+
+		void removeListener(void* source, const entities::Message& message) override {
+			removed++;
+			sender = source;
+			messages.push_back(message);
+		}
+
+		void clearListener(void* source) override {
+			cleared++;
+			sender = source;
+		}
+
+		int											added;
+		int											removed;
+		int											cleared;
+		void*										sender;
+		std::vector<entities::Message>				messages;
+
+	private:
+		entities::Observable&						m_target;
+	};
+}
+
 TEST(MessageBufferTests, BufferShouldBeLimited) {
 	// arrange
 	auto buffer = entities::MessageBuffer<2>();
@@ -28,58 +71,45 @@ TEST(MessageBufferTests, BufferShouldBeLimited) {
 TEST(MessageBufferTests, BufferShouldRaiseEventOnAdd) {
 	// arrange
 	auto buffer = entities::MessageBuffer<>();
-	auto counter = 0;
-	auto listener = [&](void* sender, const entities::Message& message) {
-		EXPECT_EQ(message, testMessages[0]);
-		EXPECT_EQ(sender, &buffer);
-		counter++;
-	};
-
-	buffer.addAddListener(listener);
+	RecordingObserver observer(buffer);
 
 	// act
 	buffer.add(testMessages[0]);
 
 	// assert
-	EXPECT_EQ(counter, 1);
+	EXPECT_EQ(observer.added, 1);
+	EXPECT_EQ(observer.sender, &buffer);
+	ASSERT_EQ(observer.messages.size(), 1u);
+	EXPECT_EQ(observer.messages[0], testMessages[0]);
 }
 
 TEST(MessageBufferTests, BufferShouldNotRaiseEventIfBufferOverfilled) {
 	// arrange
 	auto buffer = entities::MessageBuffer<1>();
-	auto counter = 0;
-	auto listener = [&](void* sender, const entities::Message& message) {
-		counter++;
-	};
-
-	buffer.addAddListener(listener);
+	RecordingObserver observer(buffer);
 
 	// act
 	buffer.add(testMessages[0]);
 	buffer.add(testMessages[1]);
 
 	// assert
-	EXPECT_EQ(counter, 1);
+	EXPECT_EQ(observer.added, 1);
 }
 
 TEST(MessageBufferTests, BufferShouldRaiseEventOnRemove) {
 	// arrange
 	auto buffer = entities::MessageBuffer<>();
-	auto counter = 0;
-	auto listener = [&](void* sender, const entities::Message& message) {
-		EXPECT_EQ(message, testMessages[0]);
-		EXPECT_EQ(sender, &buffer);
-		counter++;
-	};
-
-	buffer.addRemoveListener(listener);
 	buffer.add(testMessages[0]);
+	RecordingObserver observer(buffer);
 
 	// act
 	buffer.remove(testMessages[0]);
 
 	// assert
-	EXPECT_EQ(counter, 1);
+	EXPECT_EQ(observer.removed, 1);
+	EXPECT_EQ(observer.sender, &buffer);
+	ASSERT_EQ(observer.messages.size(), 1u);
+	EXPECT_EQ(observer.messages[0], testMessages[0]);
 }
 
 TEST(MessageBufferTests, BufferShouldNotFailIfMessageIsAbsent) {
@@ -94,36 +124,26 @@ TEST(MessageBufferTests, BufferShouldNotFailIfMessageIsAbsent) {
 TEST(MessageBufferTests, BufferShouldNotRaiseEventIfMessageIsAbsent) {
 	// arrange
 	auto buffer = entities::MessageBuffer<>();
-	auto counter = 0;
-	auto listener = [&](void* sender, const entities::Message& message) {
-		counter++;
-	};
-
-	buffer.addRemoveListener(listener);
+	RecordingObserver observer(buffer);
 
 	// act
 	buffer.remove(testMessages[0]);
 
 	// assert
-	EXPECT_EQ(counter, 0);
+	EXPECT_EQ(observer.removed, 0);
 }
 
 TEST(MessageBufferTests, BufferShouldRaiseEventOnClear) {
 	// arrange
 	auto buffer = entities::MessageBuffer<>();
-	auto counter = 0;
-	auto listener = [&](void* sender) {
-		EXPECT_EQ(sender, &buffer);
-		counter++;
-	};
-
-	buffer.addClearListener(listener);
+	RecordingObserver observer(buffer);
 
 	// act
 	buffer.clear();
 
 	// assert
-	EXPECT_EQ(counter, 1);
+	EXPECT_EQ(observer.cleared, 1);
+	EXPECT_EQ(observer.sender, &buffer);
 }
 
 TEST(MessageBufferTests, ContainsShouldReturnTrue) {
@@ -224,11 +244,9 @@ TEST(MessageBufferTests, CountShouldReturnCorrectSize) {
 TEST(MessageBufferTests, CopyConstructorShouldCopyBufferAndListeners) {
 	// arrange
 	auto buffer = entities::MessageBuffer<>();
-	auto counter = 0;
-
 	buffer.add(testMessages[0]);
 	buffer.add(testMessages[1]);
-	buffer.addAddListener([&](void*, const entities::Message&) { counter++; });
+	RecordingObserver observer(buffer);
 
 	// act
 	auto result = entities::MessageBuffer<>(buffer);
@@ -237,5 +255,71 @@ TEST(MessageBufferTests, CopyConstructorShouldCopyBufferAndListeners) {
 
 	// assert
 	EXPECT_EQ(result.count(), 3);
-	EXPECT_EQ(counter, 1);
+	EXPECT_EQ(observer.added, 1);
+	EXPECT_EQ(observer.sender, &result);
+}
+
+TEST(MessageBufferTests, UnobservedBufferShouldBeBareStorage) {
+	// arrange
+	// act
+	// assert
+	EXPECT_EQ(sizeof(entities::MessageBuffer<10, entities::Unobserved>), sizeof(std::vector<entities::Message>));
+	EXPECT_LT(sizeof(entities::MessageBuffer<10, entities::Unobserved>), sizeof(entities::MessageBuffer<10>));
+}
+
+TEST(MessageBufferTests, UnobservedBufferShouldBeLimited) {
+	// arrange
+	auto buffer = entities::MessageBuffer<2, entities::Unobserved>();
+
+	// act
+	buffer.add(testMessages[0]);
+	buffer.add(testMessages[1]);
+	buffer.add(testMessages[2]);
+	buffer.remove(testMessages[0]);
+
+	// assert
+	EXPECT_EQ(buffer.count(), 1);
+	EXPECT_EQ(buffer[0], testMessages[1]);
+}
+
+TEST(MessageBufferTests, CountedBufferShouldCountNotifications) {
+	// arrange
+	auto buffer = entities::MessageBuffer<2, entities::Counted>();
+
+	// act
+	buffer.add(testMessages[0]);
+	buffer.add(testMessages[1]);
+	buffer.add(testMessages[2]);
+	buffer.remove(testMessages[1]);
+	buffer.remove(testMessages[2]);
+	buffer.clear();
+
+	// assert
+	EXPECT_EQ(buffer.added(), 2u);
+	EXPECT_EQ(buffer.removed(), 1u);
+	EXPECT_EQ(buffer.cleared(), 1u);
+}
+
+TEST(MessageBufferTests, BufferShouldBeCopiedAcrossPolicies) {
+	// arrange
+	auto buffer = entities::MessageBuffer<2, entities::Unobserved>();
+	buffer.add(testMessages[0]);
+	buffer.add(testMessages[1]);
+
+	// act
+	auto result = entities::MessageBuffer<>(buffer);
+
+	// assert
+	EXPECT_EQ(result.count(), 2);
+	EXPECT_EQ(result[1], testMessages[1]);
+}
+
+TEST(MessageBufferTests, BiggerBufferShouldNotBeCopiedToSmaller) {
+	// arrange
+	auto buffer = entities::MessageBuffer<>();
+	auto result = entities::MessageBuffer<2, entities::Unobserved>();
+
+	// act
+	// assert
+	EXPECT_THROW(result = buffer, std::logic_error);
 }
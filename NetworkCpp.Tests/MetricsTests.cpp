@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "generators.h"
+#include "metrics.h"
+
+class MetricsTests : public testing::Test {
+};
+
+TEST(MetricsTests, MessageTimestampsShouldBeCopied) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto message = messageGenerator();
+	message.setSentAt(1.5);
+	message.setReceivedAt(4.0);
+
+	// act
+	auto result = entities::Message(message);
+
+	// assert
+	EXPECT_DOUBLE_EQ(result.sentAt(), 1.5);
+	EXPECT_DOUBLE_EQ(result.receivedAt(), 4.0);
+	EXPECT_DOUBLE_EQ(result.latency(), 2.5);
+}
+
+TEST(MetricsTests, SmallValuesShouldBeExact) {
+	// arrange
+	auto histogram = metrics::LatencyHistogram(7);
+
+	// act
+	for (std::uint64_t value = 1; value <= 100; value++) {
+		histogram.record(value);
+	}
+
+	// assert
+	EXPECT_EQ(histogram.count(), 100u);
+	EXPECT_EQ(histogram.percentile(50), 50u);
+	EXPECT_EQ(histogram.percentile(99), 99u);
+	EXPECT_EQ(histogram.min(), 1u);
+	EXPECT_EQ(histogram.max(), 100u);
+	EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+}
+
+TEST(MetricsTests, LargeValuesShouldKeepRelativePrecision) {
+	// arrange
+	auto histogram = metrics::LatencyHistogram(7);
+
+	// act
+	for (std::uint64_t value = 1; value <= 100000; value++) {
+		histogram.record(value * 1000);
+	}
+
+	// assert
+	EXPECT_NEAR(histogram.percentile(50), 50000000.0, 50000000.0 / 64);
+	EXPECT_NEAR(histogram.percentile(99), 99000000.0, 99000000.0 / 64);
+	EXPECT_NEAR(histogram.percentile(99.9), 99900000.0, 99900000.0 / 64);
+	EXPECT_EQ(histogram.percentile(100), 100000000u);
+}
+
+TEST(MetricsTests, MergedHistogramShouldMatchCombinedRecording) {
+	// arrange
+	auto first = metrics::LatencyHistogram();
+	auto second = metrics::LatencyHistogram();
+	auto combined = metrics::LatencyHistogram();
+
+	for (std::uint64_t value = 0; value < 5000; value++) {
+		(value % 3 ? first : second).record(value * value);
+		combined.record(value * value);
+	}
+
+	// act
+	first.merge(second);
+
+	// assert
+	EXPECT_EQ(first.count(), combined.count());
+	EXPECT_EQ(first.min(), combined.min());
+	EXPECT_EQ(first.max(), combined.max());
+	for (auto percent : { 10.0, 50.0, 90.0, 99.0, 99.9 }) {
+		EXPECT_EQ(first.percentile(percent), combined.percentile(percent));
+	}
+}
+
+TEST(MetricsTests, HistogramsOfDifferentPrecisionShouldNotMerge) {
+	// arrange
+	auto first = metrics::LatencyHistogram(5);
+	auto second = metrics::LatencyHistogram(7);
+
+	// act
+	// assert
+	EXPECT_THROW(first.merge(second), std::logic_error);
+}
+
+TEST(MetricsTests, RecorderShouldTrackNodesAndPairs) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto recorder = metrics::LatencyRecorder(1e-3);
+	auto first = entities::Message(1, nodes[0], nodes[1]);
+	auto second = entities::Message(1, nodes[2], nodes[1]);
+	first.setReceivedAt(0.010);
+	second.setReceivedAt(0.030);
+
+	// act
+	recorder.record(first);
+	recorder.record(second);
+
+	// assert
+	EXPECT_EQ(recorder.global().count(), 2u);
+	EXPECT_EQ(recorder.global().max(), 30u);
+	ASSERT_NE(recorder.node(nodes[1].id()), nullptr);
+	EXPECT_EQ(recorder.node(nodes[1].id())->count(), 2u);
+	EXPECT_EQ(recorder.node(nodes[0].id()), nullptr);
+	ASSERT_NE(recorder.pair(nodes[0].id(), nodes[1].id()), nullptr);
+	EXPECT_EQ(recorder.pair(nodes[0].id(), nodes[1].id())->max(), 10u);
+	EXPECT_EQ(recorder.pair(nodes[1].id(), nodes[0].id()), nullptr);
+}
+
+TEST(MetricsTests, RecordersShouldMerge) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	auto first = metrics::LatencyRecorder(1.0);
+	auto second = metrics::LatencyRecorder(1.0);
+
+	first.record(nodes[0].id(), nodes[1].id(), 5);
+	second.record(nodes[0].id(), nodes[1].id(), 7);
+	second.record(nodes[1].id(), nodes[0].id(), 9);
+	first.recordHop(2, 3);
+	second.recordHop(5, 4);
+
+	// act
+	first.merge(second);
+
+	// assert
+	EXPECT_EQ(first.global().count(), 3u);
+	EXPECT_EQ(first.node(nodes[1].id())->count(), 2u);
+	EXPECT_EQ(first.pair(nodes[1].id(), nodes[0].id())->max(), 9u);
+	EXPECT_EQ(first.link(2)->count(), 1u);
+	EXPECT_EQ(first.link(5)->max(), 4u);
+	EXPECT_EQ(first.link(3), nullptr);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "multicast.h"
+
+class MulticastTests : public testing::Test {
+};
+
+TEST(MulticastTests, FewReceiversShouldBeKeptAsSortedIndices) {
+	// arrange
+	std::vector<std::uint32_t> visited;
+
+	// act
+	auto receivers = multicast::ReceiverSet({ 900, 7, 42, 7 }, 1000);
+	receivers.forEach([&](std::uint32_t receiver) { visited.push_back(receiver); });
+
+	// assert
+	EXPECT_FALSE(receivers.isDense());
+	EXPECT_EQ(receivers.count(), 3u);
+	EXPECT_EQ(visited, std::vector<std::uint32_t>({ 7, 42, 900 }));
+	EXPECT_TRUE(receivers.contains(42));
+	EXPECT_FALSE(receivers.contains(43));
+}
+
+TEST(MulticastTests, BroadcastShouldBeKeptAsBitmap) {
+	// arrange
+	std::vector<std::uint32_t> visited;
+
+	// act
+	auto receivers = multicast::ReceiverSet::all(130, 64);
+	receivers.forEach([&](std::uint32_t receiver) { visited.push_back(receiver); });
+
+	// assert
+	EXPECT_TRUE(receivers.isDense());
+	EXPECT_EQ(receivers.count(), 129u);
+	ASSERT_EQ(visited.size(), 129u);
+	EXPECT_EQ(visited[63], 63u);
+	EXPECT_EQ(visited[64], 65u);
+	EXPECT_EQ(visited.back(), 129u);
+	EXPECT_FALSE(receivers.contains(64));
+}
+
+TEST(MulticastTests, ReceiversOutsideUniverseShouldThrow) {
+	// arrange
+	// act
+	// assert
+	EXPECT_THROW(multicast::ReceiverSet({ 1, 10 }, 10), std::invalid_argument);
+	EXPECT_THROW(multicast::MulticastMessage(1, 10, multicast::ReceiverSet({ 1 }, 10)), std::invalid_argument);
+}
+
+TEST(MulticastTests, DeliveryShouldBeCountedOncePerReceiver) {
+	// arrange
+	auto message = multicast::MulticastMessage(64, 0, multicast::ReceiverSet({ 3, 5 }, 100), 1.5);
+
+	// act
+	auto results = { message.markDelivered(3), message.markDelivered(3), message.markDelivered(4) };
+
+	// assert
+	EXPECT_EQ(std::vector<bool>(results), std::vector<bool>({ true, false, false }));
+	EXPECT_TRUE(message.isDelivered(3));
+	EXPECT_FALSE(message.isDelivered(5));
+	EXPECT_EQ(message.pending(), 1u);
+	EXPECT_FALSE(message.isComplete());
+	EXPECT_TRUE(message.markDelivered(5));
+	EXPECT_TRUE(message.isComplete());
+}
+
+TEST(MulticastTests, CopiesShouldShareHeaderAndDelivery) {
+	// arrange
+	auto message = multicast::MulticastMessage(64, 0, multicast::ReceiverSet::all(1000, 0), 1.5);
+
+	// act
+	auto copy = multicast::MulticastMessage(message);
+	copy.markDelivered(500);
+
+	// assert
+	EXPECT_EQ(copy, message);
+	EXPECT_EQ(&copy.receivers(), &message.receivers());
+	EXPECT_TRUE(message.isDelivered(500));
+	EXPECT_EQ(message.pending(), 998u);
+}
+
+TEST(MulticastTests, ConcurrentDeliveryShouldCompleteOnce) {
+	// arrange
+	const std::uint32_t universe = 4096;
+	auto message = multicast::MulticastMessage(1, 0, multicast::ReceiverSet::all(universe, 0));
+	std::vector<std::thread> threads;
+
+	// act
+	for (std::uint32_t thread = 0; thread < 4; thread++) {
+		threads.emplace_back([&message, universe]() {
+			for (std::uint32_t receiver = 1; receiver < universe; receiver++) {
+				message.markDelivered(receiver);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// assert
+	EXPECT_EQ(message.pending(), 0u);
+	EXPECT_TRUE(message.isComplete());
+}
+
+TEST(MulticastTests, ExpansionShouldCreateUnicastMessages) {
+	// arrange
+	std::vector<entities::Node> nodes(4);
+	auto message = multicast::MulticastMessage(16, 2, multicast::ReceiverSet({ 0, 3 }, 4), 2.0);
+
+	// act
+	auto results = message.expand(nodes);
+
+	// assert
+	ASSERT_EQ(results.size(), 2u);
+	EXPECT_EQ(results[0].sender(), nodes[2]);
+	EXPECT_EQ(results[0].receiver(), nodes[0]);
+	EXPECT_EQ(results[1].receiver(), nodes[3]);
+	EXPECT_EQ(results[1].size(), 16);
+	EXPECT_DOUBLE_EQ(results[1].sentAt(), 2.0);
+	EXPECT_NE(results[0], results[1]);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "networks.h"
+#include "routing.h"
+
+class NetworksTests : public testing::Test {
+};
+
+namespace {
+	bool same(const topology::Graph& first, const topology::Graph& second) {
+		if (first.nodeCount() != second.nodeCount() || first.linkCount() != second.linkCount()) {
+			return false;
+		}
+
+		for (std::uint32_t link = 0; link < first.linkCount(); link++) {
+			if (first.link(link).source != second.link(link).source || first.link(link).target != second.link(link).target) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+TEST(NetworksTests, NodesShouldBeSeededAndUnique) {
+	// arrange
+	// act
+	auto first = networks::nodes(1000, 7);
+	auto second = networks::nodes(1000, 7);
+
+	// assert
+	std::set<boost::uuids::uuid> ids;
+	for (std::size_t i = 0; i < first.size(); i++) {
+		EXPECT_EQ(first[i], second[i]);
+		ids.insert(first[i].id());
+	}
+	EXPECT_EQ(ids.size(), 1000u);
+	EXPECT_EQ(first[0].id().version(), boost::uuids::uuid::version_random_number_based);
+}
+
+TEST(NetworksTests, GeneratorsShouldNotDependOnThreadCount) {
+	// arrange
+	// act
+	// assert
+	EXPECT_TRUE(same(networks::erdosRenyi(2000, 0.01, 3, 1), networks::erdosRenyi(2000, 0.01, 3, 4)));
+	EXPECT_TRUE(same(networks::barabasiAlbert(2000, 3, 3, 1), networks::barabasiAlbert(2000, 3, 3, 4)));
+	EXPECT_TRUE(same(networks::waxman(1000, 0.2, 0.5, 3, 1), networks::waxman(1000, 0.2, 0.5, 3, 4)));
+	EXPECT_TRUE(same(networks::fatTree(8, 1), networks::fatTree(8, 4)));
+	EXPECT_TRUE(same(networks::dragonfly(4, 2, 2, 1), networks::dragonfly(4, 2, 2, 4)));
+	EXPECT_FALSE(same(networks::erdosRenyi(2000, 0.01, 3), networks::erdosRenyi(2000, 0.01, 4)));
+}
+
+TEST(NetworksTests, ErdosRenyiShouldMatchExpectedDensity) {
+	// arrange
+	const std::uint32_t nodeCount = 5000;
+	const auto probability = 0.002;
+
+	// act
+	auto graph = networks::erdosRenyi(nodeCount, probability, 11);
+
+	// assert
+	const auto expected = probability * nodeCount * (nodeCount - 1);
+	EXPECT_NEAR(graph.linkCount(), expected, expected * 0.03);
+	EXPECT_EQ(networks::erdosRenyi(50, 1.0, 1).linkCount(), 50u * 49);
+	EXPECT_EQ(networks::erdosRenyi(50, 0.0, 1).linkCount(), 0u);
+}
+
+TEST(NetworksTests, BarabasiAlbertShouldGrowHubs) {
+	// arrange
+	const std::uint32_t nodeCount = 20000;
+
+	// act
+	auto graph = networks::barabasiAlbert(nodeCount, 2, 5);
+
+	// assert
+	std::uint32_t highest = 0;
+	for (std::uint32_t node = 0; node < nodeCount; node++) {
+		highest = std::max(highest, graph.degree(node));
+	}
+	EXPECT_GT(graph.linkCount(), nodeCount * 2 * 2 * 9 / 10);
+	EXPECT_GT(highest, 100u);
+	EXPECT_GE(graph.degree(nodeCount - 1), 1u);
+}
+
+TEST(NetworksTests, WaxmanShouldPreferShortLinks) {
+	// arrange
+	// act
+	auto near = networks::waxman(2000, 0.05, 0.5, 9);
+	auto far = networks::waxman(2000, 5.0, 0.5, 9);
+
+	// assert
+	EXPECT_GT(near.linkCount(), 0u);
+	EXPECT_LT(near.linkCount() * 4, far.linkCount());
+}
+
+TEST(NetworksTests, TorusNodesShouldHaveTwoNeighboursPerDimension) {
+	// arrange
+	// act
+	auto plane = networks::torus({ 8, 5 });
+	auto space = networks::torus({ 4, 4, 4 });
+	auto ring = networks::torus({ 2, 6 });
+
+	// assert
+	EXPECT_EQ(plane.nodeCount(), 40u);
+	EXPECT_EQ(plane.degree(0), 4u);
+	EXPECT_NE(plane.find(0, 7), topology::Graph::none);
+	EXPECT_NE(plane.find(0, 32), topology::Graph::none);
+	EXPECT_EQ(space.degree(63), 6u);
+	EXPECT_EQ(ring.degree(0), 3u);
+}
+
+TEST(NetworksTests, FatTreeShouldConnectHostsThroughCore) {
+	// arrange
+	// act
+	auto graph = networks::fatTree(4);
+	auto routes = routing::RoutingTable(std::make_shared<topology::Graph>(graph));
+
+	// assert
+	EXPECT_EQ(graph.nodeCount(), 16u + 8 + 8 + 4);
+	EXPECT_EQ(graph.linkCount(), 2u * (16 + 16 + 16));
+	EXPECT_EQ(graph.degree(16), 4u);
+	EXPECT_EQ(graph.degree(35), 4u);
+	EXPECT_EQ(routes.distance(0, 1), 2u);
+	EXPECT_EQ(routes.distance(0, 2), 4u);
+	EXPECT_EQ(routes.distance(0, 15), 6u);
+}
+
+TEST(NetworksTests, DragonflyRoutersShouldBeWithinThreeHops) {
+	// arrange
+	const std::uint32_t routersPerGroup = 4;
+	const std::uint32_t globalLinks = 2;
+	const std::uint32_t groups = routersPerGroup * globalLinks + 1;
+
+	// act
+	auto graph = networks::dragonfly(routersPerGroup, 2, globalLinks);
+	auto routes = routing::RoutingTable(std::make_shared<topology::Graph>(graph));
+
+	// assert
+	EXPECT_EQ(graph.nodeCount(), groups * routersPerGroup * 3);
+	for (std::uint32_t router = 0; router < groups * routersPerGroup; router++) {
+		EXPECT_EQ(graph.degree(router), routersPerGroup - 1 + globalLinks + 2);
+		EXPECT_LE(routes.distance(router, 0), 3u);
+	}
+}
+
+TEST(NetworksTests, LargeTopologyShouldHoldEachPairOnceBothWays) {
+	// arrange
+	// act
+	auto graph = networks::erdosRenyi(200000, 10.0 / 200000, 1);
+
+	// assert
+	// blocks split the rows of the pair triangle, a seam between them must neither repeat nor lose a pair
+	EXPECT_NEAR(graph.linkCount(), 2000000.0, 20000.0);
+	for (std::uint32_t link = 0; link < graph.linkCount(); link++) {
+		const auto& ends = graph.link(link);
+		ASSERT_NE(ends.source, ends.target);
+		ASSERT_NE(graph.find(ends.target, ends.source), topology::Graph::none);
+		if (link + 1 < graph.linkCount()) {
+			ASSERT_FALSE(graph.link(link + 1).source == ends.source && graph.link(link + 1).target == ends.target);
+		}
+	}
+}
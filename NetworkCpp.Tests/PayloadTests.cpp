@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "generators.h"
+#include "multicast.h"
+#include "payload.h"
+
+class PayloadTests : public testing::Test {
+};
+
+namespace {
+	std::string text(const payload::Payload& payload) {
+		auto bytes = payload.bytes();
+		return std::string(bytes.begin(), bytes.end());
+	}
+}
+
+TEST(PayloadTests, ChunksShouldBeReusedAfterRelease) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+
+	// act
+	{
+		auto first = pool.allocate(100);
+		auto second = pool.allocate(100);
+		EXPECT_EQ(pool.freeCount(), 2u);
+	}
+
+	// assert
+	EXPECT_EQ(pool.slabCount(), 1u);
+	EXPECT_EQ(pool.freeCount(), 4u);
+}
+
+TEST(PayloadTests, SlicesShouldShareBytes) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+	auto buffer = pool.copyOf("headerbody", 10);
+
+	// act
+	auto slice = buffer.slice(6, 4);
+
+	// assert
+	EXPECT_EQ(slice.data(), buffer.data() + 6);
+	EXPECT_EQ(std::string(reinterpret_cast<const char*>(slice.data()), slice.size()), "body");
+	EXPECT_FALSE(buffer.isUnique());
+	EXPECT_THROW(buffer.mutableData(), std::logic_error);
+	EXPECT_THROW(buffer.slice(6, 5), std::out_of_range);
+}
+
+TEST(PayloadTests, HeadersShouldBePrependedIntoHeadroom) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+	auto payload = payload::Payload(pool.copyOf("body", 4));
+
+	// act
+	payload.prepend("ip|", 3, pool);
+	payload.prepend("eth|", 4, pool);
+
+	// assert
+	EXPECT_EQ(payload.segmentCount(), 1u);
+	EXPECT_EQ(text(payload), "eth|ip|body");
+	EXPECT_EQ(payload.segment(0).headroom(), 9u);
+}
+
+TEST(PayloadTests, SharedPayloadShouldGetSeparateHeaderSegment) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+	auto original = payload::Payload(pool.copyOf("body", 4));
+	auto copy = original;
+
+	// act
+	copy.prepend("hdr|", 4, pool);
+
+	// assert
+	EXPECT_EQ(copy.segmentCount(), 2u);
+	EXPECT_EQ(copy.segment(1).data(), original.segment(0).data());
+	EXPECT_EQ(text(copy), "hdr|body");
+	EXPECT_EQ(text(original), "body");
+}
+
+TEST(PayloadTests, StripAndSliceShouldSpanSegments) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+	auto payload = payload::Payload(pool.copyOf("abc", 3));
+	payload.append(pool.copyOf("defg", 4));
+	payload.append(pool.copyOf("hi", 2));
+
+	// act
+	auto slice = payload.slice(2, 5);
+	payload.strip(4);
+
+	// assert
+	EXPECT_EQ(text(slice), "cdefg");
+	EXPECT_EQ(slice.segmentCount(), 2u);
+	EXPECT_EQ(text(payload), "efghi");
+	EXPECT_EQ(payload.segmentCount(), 2u);
+	EXPECT_THROW(payload.strip(6), std::out_of_range);
+}
+
+TEST(PayloadTests, OversizedBufferShouldBypassSlabs) {
+	// arrange
+	payload::SlabPool pool(256, 4, 16);
+	std::vector<unsigned char> bytes(1000, 7);
+
+	// act
+	auto buffer = pool.copyOf(bytes.data(), bytes.size());
+
+	// assert
+	EXPECT_EQ(buffer.size(), 1000u);
+	EXPECT_EQ(buffer.data()[999], 7);
+	EXPECT_EQ(pool.slabCount(), 0u);
+}
+
+TEST(PayloadTests, BuffersShouldOutlivePool) {
+	// arrange
+	payload::Buffer buffer;
+
+	// act
+	{
+		payload::SlabPool pool(256, 4, 16);
+		buffer = pool.copyOf("kept", 4);
+	}
+
+	// assert
+	EXPECT_EQ(std::string(reinterpret_cast<const char*>(buffer.data()), buffer.size()), "kept");
+}
+
+TEST(PayloadTests, ForwardedMessagesShouldShareBytes) {
+	// arrange
+	auto messageGenerator = generators::MessageGenerator();
+	auto message = messageGenerator();
+	message.setPayload(payload::Payload(payload::SlabPool::shared().copyOf("data", 4)));
+
+	// act
+	auto forwarded = entities::Message(message);
+	auto assigned = messageGenerator();
+	assigned = forwarded;
+
+	// assert
+	EXPECT_EQ(message.size(), 4);
+	EXPECT_EQ(&assigned.payload(), &message.payload());
+	EXPECT_EQ(text(assigned.payload()), "data");
+}
+
+TEST(PayloadTests, MulticastExpansionShouldShareBody) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	auto body = payload::Payload(payload::SlabPool::shared().copyOf("data", 4));
+	auto message = multicast::MulticastMessage(body, 0, multicast::ReceiverSet::all(3, 0));
+
+	// act
+	auto results = message.expand(nodes);
+
+	// assert
+	EXPECT_EQ(message.size(), 4);
+	ASSERT_EQ(results.size(), 2u);
+	EXPECT_EQ(&results[0].payload(), &results[1].payload());
+	EXPECT_EQ(results[0].payload().segment(0).data(), body.segment(0).data());
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "queueing.h"
+
+class QueueingTests : public testing::Test {
+};
+
+namespace {
+	// fraction of arrivals lost by a single server queue holding at most capacity messages, service is constant
+	double simulateDeterministic(const double arrivalRate, const double service, const std::size_t capacity,
+		const std::size_t arrivals) {
+		std::mt19937_64 generator(17);
+		std::exponential_distribution<double> gaps(arrivalRate);
+		std::vector<double> departures;
+		std::size_t lost = 0;
+		auto time = 0.0;
+
+		for (std::size_t i = 0; i < arrivals; i++) {
+			time += gaps(generator);
+			while (!departures.empty() && departures.front() <= time) {
+				departures.erase(departures.begin());
+			}
+
+			if (departures.size() >= capacity) {
+				lost++;
+				continue;
+			}
+			departures.push_back((departures.empty() ? time : departures.back()) + service);
+		}
+
+		return static_cast<double>(lost) / arrivals;
+	}
+}
+
+TEST(QueueingTests, ClosedFormShouldMatchKnownValues) {
+	// arrange
+	// act
+	auto estimate = queueing::mm1k(1.0, 2.0, 3);
+	auto saturated = queueing::mm1k(2.0, 1.0, 3);
+	auto balanced = queueing::mm1k(1.0, 1.0, 3);
+
+	// assert
+	EXPECT_NEAR(estimate.dropProbability, 0.5 * 0.125 / 0.9375, 1e-12);
+	EXPECT_NEAR(estimate.occupancy, 0.7 + 1.0 / 30, 1e-12);
+	EXPECT_NEAR(estimate.throughput, 1 - estimate.dropProbability, 1e-12);
+	EXPECT_NEAR(saturated.dropProbability, 8.0 / 15, 1e-12);
+	EXPECT_NEAR(saturated.occupancy, 3 - estimate.occupancy, 1e-12);
+	EXPECT_NEAR(balanced.dropProbability, 0.25, 1e-12);
+	EXPECT_EQ(estimate.flags, queueing::Reliable);
+	EXPECT_EQ(balanced.flags, queueing::NearSaturation);
+	EXPECT_THROW(queueing::mm1k(1.0, 1.0, 0), std::invalid_argument);
+}
+
+TEST(QueueingTests, ExponentialServiceShouldMatchClosedForm) {
+	// arrange
+	const double loads[] = { 0.3, 0.95, 1.0, 1.7 };
+
+	for (auto load : loads) {
+		// act
+		auto sweep = queueing::mg1k(load, 1.0, 1.0, 40);
+
+		// assert
+		ASSERT_EQ(sweep.size(), 40u);
+		for (const auto& estimate : sweep) {
+			auto expected = queueing::mm1k(load, 1.0, estimate.capacity);
+			EXPECT_NEAR(estimate.dropProbability, expected.dropProbability, 1e-9);
+			EXPECT_NEAR(estimate.occupancy, expected.occupancy, 1e-7);
+			EXPECT_NEAR(estimate.waitingTime, expected.waitingTime, 1e-7);
+		}
+	}
+}
+
+TEST(QueueingTests, LossShouldNotDependOnServiceWithoutWaitingRoom) {
+	// arrange
+	// act
+	// assert
+	for (auto scv : { 0.0, 0.5, 1.0, 4.0 }) {
+		EXPECT_NEAR(queueing::mg1k(2.0, 0.5, scv, 1)[0].dropProbability, 0.5, 1e-9);
+	}
+}
+
+TEST(QueueingTests, DeterministicServiceShouldMatchSimulation) {
+	// arrange
+	const auto capacity = 5;
+
+	// act
+	auto estimate = queueing::mg1k(0.9, 1.0, 0.0, capacity).back();
+	auto simulated = simulateDeterministic(0.9, 1.0, capacity, 2000000);
+
+	// assert
+	EXPECT_NEAR(estimate.dropProbability, simulated, simulated * 0.03);
+	EXPECT_LT(estimate.dropProbability, queueing::mm1k(0.9, 1.0, capacity).dropProbability);
+	EXPECT_EQ(estimate.flags, queueing::NearSaturation);
+	EXPECT_EQ(queueing::mg1k(0.5, 1.0, 3.0, 4).back().flags, queueing::HighVariability);
+}
+
+TEST(QueueingTests, SweepShouldFindSmallestCapacity) {
+	// arrange
+	auto sweep = queueing::mg1k(0.7, 1.0, 1.0, 200);
+
+	// act
+	auto capacity = queueing::capacityFor(sweep, 1e-6);
+
+	// assert
+	ASSERT_GT(capacity, 1u);
+	EXPECT_LE(queueing::mm1k(0.7, 1.0, capacity).dropProbability, 1e-6);
+	EXPECT_GT(queueing::mm1k(0.7, 1.0, capacity - 1).dropProbability, 1e-6);
+	EXPECT_EQ(queueing::capacityFor(queueing::mg1k(3.0, 1.0, 1.0, 50), 0.1), 0u);
+}
+
+TEST(QueueingTests, LoadModelShouldDeriveLinkRatesFromRoutes) {
+	// arrange
+	std::vector<topology::Link> links = { { 0, 1 }, { 1, 0 }, { 1, 2 }, { 2, 1 } };
+	auto routes = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(3, links));
+
+	std::vector<topology::Link> longer = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 } };
+	auto chain = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(5, longer));
+
+	// act
+	auto model = queueing::LoadModel(routes, 6.0, 2.0);
+	auto estimates = model.estimate(0.5, 1.0, 10);
+	auto last = queueing::LoadModel(chain, 20.0).estimate(3, 0.25, 1.0, 10);
+
+	// assert
+	const double transit[] = { 0.0, 0.5, 0.5, 0.0 };
+	for (std::uint32_t link = 0; link < 4; link++) {
+		EXPECT_NEAR(model.arrivalRate(link), 2.0, 1e-12);
+		EXPECT_NEAR(model.transitShare(link), transit[link], 1e-12);
+		EXPECT_NEAR(estimates[link].dropProbability, queueing::mm1k(2.0, 2.0, 10).dropProbability, 1e-9);
+		EXPECT_EQ(estimates[link].flags, queueing::NearSaturation | queueing::NonPoissonArrivals);
+	}
+	EXPECT_NEAR(last.back().throughput, 4.0 * (1 - last.back().dropProbability), 1e-12);
+	EXPECT_EQ(last.back().flags, queueing::NearSaturation | queueing::TransitTraffic);
+}
+
+TEST(QueueingTests, LoadModelShouldNotFillSharedRoutes) {
+	// arrange
+	std::vector<topology::Link> links = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+	auto routes = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(4, links));
+	routes->nextLink(0, 2);
+
+	// act
+	auto model = queueing::LoadModel(routes, 12.0);
+
+	// assert
+	EXPECT_NEAR(model.arrivalRate(0), 6.0, 1e-12);
+	EXPECT_EQ(routes->treeCount(), 1u);
+	EXPECT_EQ(routes->nextLink(0, 2), 0u);
+	EXPECT_EQ(routes->treeCount(), 1u);
+	EXPECT_THROW(routes->release(4), std::out_of_range);
+}
+
+TEST(QueueingTests, LongSweepShouldStayStableNearSaturation) {
+	// arrange
+	const std::size_t capacity = 2000;
+
+	// act
+	auto sweep = queueing::mg1k(0.98, 1.0, 0.5, capacity);
+	auto exponential = queueing::mg1k(0.98, 1.0, 1.0, capacity);
+
+	// assert
+	ASSERT_EQ(sweep.size(), capacity);
+	for (std::size_t i = 0; i < sweep.size(); i++) {
+		ASSERT_TRUE(std::isfinite(sweep[i].occupancy));
+		ASSERT_GE(sweep[i].dropProbability, 0.0);
+		ASSERT_LE(sweep[i].occupancy, static_cast<double>(sweep[i].capacity));
+		if (i > 0) {
+			ASSERT_LE(sweep[i].dropProbability, sweep[i - 1].dropProbability);
+			ASSERT_GE(sweep[i].occupancy, sweep[i - 1].occupancy);
+		}
+	}
+
+	// the rescaled recursion should still agree with the closed form after thousands of levels
+	for (std::size_t size : { 1, 10, 100, 1000, 2000 }) {
+		const auto expected = queueing::mm1k(0.98, 1.0, size);
+		EXPECT_NEAR(exponential[size - 1].dropProbability, expected.dropProbability, 1e-9);
+		EXPECT_NEAR(exponential[size - 1].occupancy, expected.occupancy, 1e-6 * expected.occupancy);
+	}
+}
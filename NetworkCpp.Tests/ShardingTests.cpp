@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "forwarding.h"
+#include "networks.h"
+#include "sharding.h"
+
+class ShardingTests : public testing::Test {
+};
+
+namespace {
+	std::vector<traffic::Arrival> generate(const std::uint32_t nodeCount, const double rate, const std::size_t count) {
+		auto generator = traffic::TrafficGenerator(nodeCount, std::make_shared<traffic::PoissonArrivals>(rate),
+			std::make_shared<traffic::ConstantSize>(64), 5);
+		std::vector<traffic::Arrival> arrivals;
+		generator.generate(arrivals, count);
+
+		return arrivals;
+	}
+
+	sharding::Options options(const unsigned shards, const std::size_t queueCapacity) {
+		sharding::Options options;
+		options.shards = shards;
+		options.stepDuration = 0.01;
+		options.queueCapacity = queueCapacity;
+
+		return options;
+	}
+}
+
+TEST(ShardingTests, NodesShouldBeSplitIntoContiguousBlocks) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 4, 4 }));
+
+	// act
+	auto simulation = sharding::ShardedSimulation(graph, std::vector<traffic::Arrival>(), options(3, 8));
+	auto clamped = sharding::ShardedSimulation(graph, std::vector<traffic::Arrival>(), options(40, 8));
+
+	// assert
+	EXPECT_EQ(simulation.shardCount(), 3u);
+	EXPECT_EQ(simulation.shardOf(0), 0u);
+	EXPECT_EQ(simulation.shardOf(5), 1u);
+	EXPECT_EQ(simulation.shardOf(15), 2u);
+	EXPECT_GT(simulation.crossLinks(), 0u);
+	EXPECT_EQ(clamped.shardCount(), 16u);
+	EXPECT_EQ(clamped.crossLinks(), graph->linkCount());
+	EXPECT_THROW(simulation.shardOf(16), std::out_of_range);
+}
+
+TEST(ShardingTests, InvalidInputShouldBeRejected) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 4, 4 }));
+	auto unordered = std::vector<traffic::Arrival>{ { 1.0, 0, 1, 8 }, { 0.5, 1, 0, 8 } };
+	auto outside = std::vector<traffic::Arrival>{ { 1.0, 0, 16, 8 } };
+
+	// act
+	// assert
+	EXPECT_THROW(sharding::ShardedSimulation(nullptr, unordered), std::invalid_argument);
+	EXPECT_THROW(sharding::ShardedSimulation(graph, unordered), std::invalid_argument);
+	EXPECT_THROW(sharding::ShardedSimulation(graph, outside), std::invalid_argument);
+	EXPECT_THROW(sharding::ShardedSimulation(graph, std::vector<traffic::Arrival>(), options(0, 8)), std::invalid_argument);
+	EXPECT_NO_THROW(sharding::ShardedSimulation::numaNodes());
+}
+
+TEST(ShardingTests, SelfAddressedArrivalsShouldHaveNoLatency) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 4 }));
+	auto arrivals = std::vector<traffic::Arrival>{ { 0.25, 1, 1, 8 }, { 0.5, 0, 2, 8 }, { 2.75, 3, 3, 8 } };
+	auto simulationOptions = options(1, 8);
+	simulationOptions.stepDuration = 1.0;
+
+	// act
+	const auto result = sharding::ShardedSimulation(graph, arrivals, simulationOptions).run(100);
+
+	// assert
+	EXPECT_EQ(result.delivered, 3u);
+	EXPECT_EQ(result.received[1], 1u);
+	EXPECT_EQ(result.received[3], 1u);
+	EXPECT_DOUBLE_EQ(result.latency[1], 0.0);
+	EXPECT_DOUBLE_EQ(result.latency[3], 0.0);
+	EXPECT_DOUBLE_EQ(result.latency[2], 1.5);
+}
+
+TEST(ShardingTests, SingleShardShouldMatchForwardingEngine) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 6, 6 }));
+	auto arrivals = generate(graph->nodeCount(), 1e6, 2000);
+	for (auto& arrival : arrivals) {
+		arrival.time = 0;
+	}
+
+	std::vector<entities::Node> nodes(graph->nodeCount());
+	auto engine = forwarding::ForwardingEngine(nodes, std::make_shared<routing::RoutingTable>(graph), 1.0, 1000);
+	for (const auto& arrival : arrivals) {
+		nodes[arrival.source].buffer().add(entities::Message(arrival.size, nodes[arrival.source], nodes[arrival.destination]));
+	}
+	auto simulationOptions = options(1, 8);
+	simulationOptions.stepDuration = 1.0;
+	simulationOptions.linkCapacity = 1000;
+	simulationOptions.queueCapacity = std::numeric_limits<std::size_t>::max();
+
+	// act
+	const auto steps = engine.run(1000);
+	const auto result = sharding::ShardedSimulation(graph, arrivals, simulationOptions).run(1000);
+
+	// assert
+	EXPECT_EQ(result.steps, steps);
+	EXPECT_EQ(result.delivered, engine.delivered());
+	EXPECT_EQ(result.forwarded, engine.forwarded());
+	for (std::uint32_t node = 0; node < graph->nodeCount(); node++) {
+		EXPECT_EQ(result.received[node], static_cast<std::uint64_t>(nodes[node].receivedMessages().count()));
+	}
+}
+
+TEST(ShardingTests, BoundedQueuesShouldMatchForwardingEngine) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 6, 6 }));
+	auto arrivals = generate(graph->nodeCount(), 30.0, 3000);
+
+	std::vector<entities::Node> nodes(graph->nodeCount());
+	auto engine = forwarding::ForwardingEngine(nodes, std::make_shared<routing::RoutingTable>(graph), 1.0, 1, 2);
+	auto simulationOptions = options(1, 2);
+	simulationOptions.stepDuration = 1.0;
+
+	// act
+	std::size_t next = 0;
+	std::size_t steps = 0;
+	while (steps < 100000 && (next < arrivals.size() || !engine.isIdle())) {
+		for (; next < arrivals.size() && arrivals[next].time < engine.time() + 1.0; next++) {
+			const auto& arrival = arrivals[next];
+			nodes[arrival.source].buffer().add(entities::Message(arrival.size, nodes[arrival.source], nodes[arrival.destination]));
+		}
+		engine.step();
+		steps++;
+	}
+	const auto result = sharding::ShardedSimulation(graph, arrivals, simulationOptions).run(100000);
+
+	// assert
+	EXPECT_GT(engine.dropped(), 0u);
+	EXPECT_EQ(result.steps, steps);
+	EXPECT_EQ(result.delivered, engine.delivered());
+	EXPECT_EQ(result.forwarded, engine.forwarded());
+	EXPECT_EQ(result.dropped, engine.dropped());
+	for (std::uint32_t node = 0; node < graph->nodeCount(); node++) {
+		EXPECT_EQ(result.received[node], static_cast<std::uint64_t>(nodes[node].receivedMessages().count()));
+	}
+}
+
+#if defined(__linux__)
+TEST(ShardingTests, ResultsShouldNotDependOnShardCount) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 8, 8 }));
+	auto arrivals = generate(graph->nodeCount(), 2000.0, 20000);
+
+	// act
+	const auto reference = sharding::ShardedSimulation(graph, arrivals, options(1, 4)).run(100000);
+	std::vector<sharding::Result> sharded;
+	for (unsigned shards = 2; shards <= 4; shards++) {
+		sharded.push_back(sharding::ShardedSimulation(graph, arrivals, options(shards, 4)).run(100000));
+	}
+
+	// assert
+	EXPECT_GT(reference.dropped, 0u);
+	EXPECT_EQ(reference.delivered + reference.dropped, arrivals.size());
+	EXPECT_EQ(std::accumulate(reference.received.begin(), reference.received.end(), std::uint64_t(0)), reference.delivered);
+	for (const auto& result : sharded) {
+		EXPECT_EQ(result.steps, reference.steps);
+		EXPECT_EQ(result.delivered, reference.delivered);
+		EXPECT_EQ(result.forwarded, reference.forwarded);
+		EXPECT_EQ(result.dropped, reference.dropped);
+		EXPECT_EQ(result.received, reference.received);
+		EXPECT_EQ(result.latency, reference.latency);
+	}
+}
+
+TEST(ShardingTests, StepLimitShouldStopEveryShard) {
+	// arrange
+	auto graph = std::make_shared<topology::Graph>(networks::torus({ 8, 8 }));
+	auto arrivals = generate(graph->nodeCount(), 2000.0, 5000);
+
+	// act
+	const auto result = sharding::ShardedSimulation(graph, arrivals, options(4, 4)).run(10);
+
+	// assert
+	EXPECT_EQ(result.steps, 10u);
+	EXPECT_LT(result.delivered + result.dropped, arrivals.size());
+}
+#endif
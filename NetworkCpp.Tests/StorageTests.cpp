@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "storage.h"
+
+class StorageTests : public testing::Test {
+};
+
+TEST(StorageTests, BlocksShouldBeReusedAfterRelease) {
+	// arrange
+	storage::SegmentedPool pool(24, 4);
+
+	// act
+	auto first = pool.allocate();
+	auto second = pool.allocate();
+	pool.deallocate(first);
+	auto third = pool.allocate();
+
+	// assert
+	EXPECT_EQ(third, first);
+	EXPECT_NE(second, first);
+	EXPECT_EQ(pool.segmentCount(), 1u);
+	EXPECT_EQ(pool.freeCount(), 2u);
+	EXPECT_EQ(pool.blockSize() % alignof(std::max_align_t), 0u);
+}
+
+TEST(StorageTests, PoolShouldGrowBySegments) {
+	// arrange
+	storage::SegmentedPool pool(32, 8);
+	std::set<void*> blocks;
+
+	// act
+	for (auto i = 0; i < 20; i++) {
+		blocks.insert(pool.allocate());
+	}
+
+	// assert
+	EXPECT_EQ(blocks.size(), 20u);
+	EXPECT_EQ(pool.segmentCount(), 3u);
+	EXPECT_EQ(pool.freeCount(), 4u);
+	for (auto block : blocks) {
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t), 0u);
+	}
+}
+
+TEST(StorageTests, SizesShouldMapToClasses) {
+	// arrange
+	// act
+	// assert
+	EXPECT_EQ(&storage::SegmentedPool::forSize(1), &storage::SegmentedPool::forSize(16));
+	EXPECT_NE(&storage::SegmentedPool::forSize(16), &storage::SegmentedPool::forSize(17));
+	EXPECT_GE(storage::SegmentedPool::forSize(200).blockSize(), 200u);
+	EXPECT_THROW(storage::SegmentedPool::forSize(257), std::invalid_argument);
+}
+
+TEST(StorageTests, SharedObjectsShouldComeFromPool) {
+	// arrange
+	auto allocator = storage::PoolAllocator<std::vector<int>>();
+
+	// act
+	auto first = std::allocate_shared<std::vector<int>>(allocator, 3, 7);
+	auto second = std::allocate_shared<std::vector<int>>(allocator, *first);
+	first.reset();
+
+	// assert
+	EXPECT_EQ(*second, std::vector<int>({ 7, 7, 7 }));
+}
+
+TEST(StorageTests, SmallArraysShouldComeFromPool) {
+	// arrange
+	auto& pool = storage::SegmentedPool::forSize(12 * sizeof(int));
+	pool.deallocate(pool.allocate());
+	const auto available = pool.freeCount();
+	std::vector<int, storage::PoolAllocator<int>> small;
+	std::vector<int, storage::PoolAllocator<int>> large;
+
+	// act
+	small.reserve(12);
+	const auto pooled = pool.freeCount();
+	large.reserve(1000);
+	small.assign(12, 3);
+
+	// assert
+	EXPECT_EQ(pooled, available - 1);
+	EXPECT_EQ(pool.freeCount(), available - 1);
+	EXPECT_EQ(small.size(), 12u);
+	EXPECT_EQ(small[11], 3);
+	EXPECT_GE(large.capacity(), 1000u);
+}
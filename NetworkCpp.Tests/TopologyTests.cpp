@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "routing.h"
+#include "topology.h"
+
+class TopologyTests : public testing::Test {
+};
+
+TEST(TopologyTests, LinksShouldBeGroupedBySourceWithoutDuplicates) {
+	// arrange
+	std::vector<topology::Link> links = { { 2, 0 }, { 0, 2 }, { 0, 1 }, { 0, 2 }, { 1, 1 } };
+
+	// act
+	auto graph = topology::Graph(3, links);
+
+	// assert
+	EXPECT_EQ(graph.linkCount(), 3u);
+	EXPECT_EQ(graph.degree(0), 2u);
+	EXPECT_EQ(graph.degree(1), 0u);
+	EXPECT_EQ(graph.link(graph.outBegin(0)).target, 1u);
+	EXPECT_EQ(graph.find(0, 2), 1u);
+	EXPECT_EQ(graph.find(2, 1), topology::Graph::none);
+	EXPECT_EQ(graph.inEnd(0) - graph.inBegin(0), 1u);
+	EXPECT_EQ(graph.link(graph.inLink(graph.inBegin(0))).source, 2u);
+}
+
+TEST(TopologyTests, PairsShouldBecomeLinksBothWays) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	entities::OneWayChannel channel;
+	std::vector<entities::NodesPair> pairs = { entities::NodesPair(nodes[0], nodes[1], channel),
+		entities::NodesPair(nodes[1], nodes[2], channel) };
+
+	// act
+	auto graph = topology::Graph(nodes, pairs);
+
+	// assert
+	EXPECT_EQ(graph.linkCount(), 4u);
+	EXPECT_NE(graph.find(1, 0), topology::Graph::none);
+	EXPECT_NE(graph.find(2, 1), topology::Graph::none);
+	EXPECT_EQ(graph.find(0, 2), topology::Graph::none);
+}
+
+TEST(TopologyTests, PairsWithUnknownNodesShouldThrow) {
+	// arrange
+	std::vector<entities::Node> nodes(2);
+	entities::Node stranger;
+	entities::OneWayChannel channel;
+	std::vector<entities::NodesPair> pairs = { entities::NodesPair(nodes[0], stranger, channel) };
+
+	// act
+	// assert
+	EXPECT_THROW(topology::Graph(nodes, pairs), std::invalid_argument);
+}
+
+TEST(TopologyTests, RoutesShouldFollowShortestPaths) {
+	// arrange
+	// a ring of six nodes with a chord between 0 and 3
+	std::vector<topology::Link> links;
+	for (std::uint32_t i = 0; i < 6; i++) {
+		links.push_back({ i, (i + 1) % 6 });
+		links.push_back({ (i + 1) % 6, i });
+	}
+	links.push_back({ 0, 3 });
+	links.push_back({ 3, 0 });
+	auto routes = routing::RoutingTable(std::make_shared<topology::Graph>(6, links));
+
+	// act
+	const auto next = routes.nextLink(5, 2);
+
+	// assert
+	EXPECT_EQ(routes.distance(5, 2), 3u);
+	EXPECT_EQ(routes.distance(1, 4), 3u);
+	EXPECT_EQ(routes.distance(0, 4), 2u);
+	EXPECT_EQ(routes.graph().link(next).source, 5u);
+	EXPECT_EQ(routes.distance(routes.graph().link(next).target, 2), 2u);
+	EXPECT_EQ(routes.nextLink(2, 2), topology::Graph::none);
+	EXPECT_EQ(routes.treeCount(), 2u);
+}
+
+TEST(TopologyTests, DisconnectedNodesShouldHaveNoRoute) {
+	// arrange
+	auto routes = routing::RoutingTable(std::make_shared<topology::Graph>(3, std::vector<topology::Link>({ { 0, 1 } })));
+
+	// act
+	// assert
+	EXPECT_EQ(routes.distance(0, 1), 1u);
+	EXPECT_EQ(routes.nextLink(1, 0), topology::Graph::none);
+	EXPECT_EQ(routes.distance(2, 1), topology::Graph::none);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "forwarding.h"
+#include "tracing.h"
+
+class TracingTests : public testing::Test {
+};
+
+namespace {
+	boost::property_tree::ptree parse(const std::string& trace) {
+		std::istringstream stream(trace);
+		boost::property_tree::ptree tree;
+		boost::property_tree::read_json(stream, tree);
+		return tree;
+	}
+
+	std::size_t countOf(const boost::property_tree::ptree& tree, const std::string& phase, const std::string& name) {
+		std::size_t count = 0;
+		for (const auto& event : tree.get_child("traceEvents")) {
+			if (event.second.get<std::string>("ph") == phase && event.second.get<std::string>("name") == name) {
+				count++;
+			}
+		}
+
+		return count;
+	}
+
+	struct CountingBuffer : std::streambuf {
+		std::size_t									writes = 0;
+		std::size_t									largestWrite = 0;
+		std::uint64_t								lines = 0;
+
+		std::streamsize xsputn(const char* data, const std::streamsize size) override {
+			writes++;
+			largestWrite = std::max<std::size_t>(largestWrite, static_cast<std::size_t>(size));
+			lines += std::count(data, data + size, '\n');
+			return size;
+		}
+
+		int_type overflow(const int_type character) override {
+			lines += character == '\n' ? 1 : 0;
+			return traits_type::not_eof(character);
+		}
+	};
+}
+
+TEST(TracingTests, TraceShouldBeValidChromeJson) {
+	// arrange
+	std::ostringstream stream;
+	tracing::TraceWriter writer(stream);
+
+	// act
+	writer.name(tracing::Kind::Node, 0, "gateway \"a\"");
+	writer.busy(tracing::Kind::Link, 3, 1.0, true);
+	writer.counter(tracing::Kind::Link, 3, 1.0, 5);
+	writer.drop(tracing::Kind::Node, 0, 1.5);
+	writer.busy(tracing::Kind::Link, 3, 2.5, false);
+	writer.close(3.0);
+
+	// assert
+	auto tree = parse(stream.str());
+	EXPECT_EQ(countOf(tree, "M", "process_name"), 2u);
+	EXPECT_EQ(countOf(tree, "M", "thread_name"), 3u);
+	EXPECT_EQ(countOf(tree, "C", "depth"), 1u);
+	EXPECT_EQ(countOf(tree, "i", "drop"), 1u);
+	for (const auto& event : tree.get_child("traceEvents")) {
+		if (event.second.get<std::string>("ph") == "X") {
+			EXPECT_EQ(event.second.get<int>("pid"), 1);
+			EXPECT_EQ(event.second.get<int>("tid"), 3);
+			EXPECT_DOUBLE_EQ(event.second.get<double>("ts"), 1e6);
+			EXPECT_DOUBLE_EQ(event.second.get<double>("dur"), 1.5e6);
+		}
+	}
+	EXPECT_TRUE(writer.isClosed());
+	EXPECT_THROW(writer.busy(tracing::Kind::Link, 3, 4.0, true), std::logic_error);
+}
+
+TEST(TracingTests, OpenSpansShouldBeClosedAtEnd) {
+	// arrange
+	std::ostringstream stream;
+	std::vector<entities::Channel> channels(3);
+	std::vector<entities::Channel*> pointers = { &channels[0], &channels[1], &channels[2] };
+
+	// act
+	{
+		tracing::TraceWriter writer(stream);
+		channels[0].setIsBusy(true);
+		writer.sample(pointers, 0.0);
+		channels[0].setIsBusy(false);
+		channels[2].setIsBusy(true);
+		writer.sample(pointers, 1.0);
+	}
+
+	// assert
+	auto tree = parse(stream.str());
+	EXPECT_EQ(countOf(tree, "X", "busy"), 2u);
+}
+
+TEST(TracingTests, SamplingAndFilteringShouldThinEvents) {
+	// arrange
+	std::ostringstream stream;
+	auto options = tracing::Options();
+	options.dropSampling = 10;
+	options.counterInterval = 5.0;
+	options.filter = [](tracing::Kind kind, std::uint32_t index) { return kind != tracing::Kind::Link || index % 2 == 0; };
+	tracing::TraceWriter writer(stream, options);
+
+	// act
+	for (std::uint32_t i = 0; i < 100; i++) {
+		writer.drop(tracing::Kind::Node, 0, i);
+		writer.drop(tracing::Kind::Link, 1, i);
+		writer.counter(tracing::Kind::Link, 2, i, i + 1);
+	}
+	writer.counter(tracing::Kind::Link, 2, 100.0, 0);
+	writer.close(100.0);
+
+	// assert
+	auto tree = parse(stream.str());
+	EXPECT_EQ(countOf(tree, "i", "drop"), 10u);
+	EXPECT_EQ(countOf(tree, "C", "depth"), 21u);
+	EXPECT_EQ(countOf(tree, "M", "thread_name"), 2u);
+	options.dropSampling = 0;
+	EXPECT_THROW(tracing::TraceWriter(stream, options), std::invalid_argument);
+}
+
+TEST(TracingTests, EngineShouldTraceLinksQueuesAndDrops) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	std::vector<topology::Link> links = { { 0, 1 }, { 1, 2 } };
+	auto routes = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(3, links));
+	auto engine = forwarding::ForwardingEngine(nodes, routes, 1.0, 1, 3);
+	std::ostringstream stream;
+	auto writer = std::make_shared<tracing::TraceWriter>(stream);
+	engine.setTracer(writer);
+	for (auto i = 0; i < 5; i++) {
+		nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	}
+
+	// act
+	engine.run(100);
+	writer->close(engine.time());
+
+	// assert
+	auto tree = parse(stream.str());
+	EXPECT_EQ(engine.dropped(), 2u);
+	EXPECT_EQ(countOf(tree, "i", "drop"), 2u);
+	EXPECT_EQ(countOf(tree, "X", "busy"), 2u);
+	for (const auto& event : tree.get_child("traceEvents")) {
+		if (event.second.get<std::string>("ph") == "X") {
+			EXPECT_DOUBLE_EQ(event.second.get<double>("dur"), 3e6);
+		}
+	}
+	EXPECT_GE(countOf(tree, "C", "depth"), 4u);
+}
+
+TEST(TracingTests, EngineShouldTraceOnlyChangedNodeDepths) {
+	// arrange
+	std::vector<entities::Node> nodes(10);
+	std::vector<topology::Link> links = { { 0, 1 }, { 1, 2 } };
+	auto routes = std::make_shared<routing::RoutingTable>(std::make_shared<topology::Graph>(10, links));
+	auto engine = forwarding::ForwardingEngine(nodes, routes, 1.0, 4, 4);
+	std::ostringstream stream;
+	auto writer = std::make_shared<tracing::TraceWriter>(stream);
+	engine.setTracer(writer);
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+	nodes[0].buffer().add(entities::Message(1, nodes[0], nodes[2]));
+
+	// act
+	engine.run(100);
+	engine.step();
+	writer->close(engine.time());
+
+	// assert
+	auto tree = parse(stream.str());
+	std::size_t nodeTracks = 0;
+	std::size_t nodeDepths = 0;
+	for (const auto& event : tree.get_child("traceEvents")) {
+		if (event.second.get<int>("pid", 0) != static_cast<int>(tracing::Kind::Node)) {
+			continue;
+		}
+		nodeTracks += event.second.get<std::string>("name") == "thread_name" ? 1 : 0;
+		nodeDepths += event.second.get<std::string>("name") == "depth" ? 1 : 0;
+	}
+	EXPECT_EQ(engine.delivered(), 2u);
+	EXPECT_EQ(nodeTracks, 1u);
+	EXPECT_EQ(nodeDepths, 2u);
+}
+
+TEST(TracingTests, LongTraceShouldBeStreamedInBoundedWrites) {
+	// arrange
+	CountingBuffer buffer;
+	std::ostream stream(&buffer);
+	tracing::TraceWriter writer(stream);
+	std::size_t largestPending = 0;
+
+	// act
+	for (std::uint32_t i = 0; i < 250000; i++) {
+		writer.busy(tracing::Kind::Link, i % 1000, i, true);
+		writer.counter(tracing::Kind::Link, i % 1000, i, i % 7 + 1);
+		writer.drop(tracing::Kind::Node, i % 1000, i);
+		writer.busy(tracing::Kind::Link, i % 1000, i + 0.5, false);
+		largestPending = std::max<std::size_t>(largestPending, writer.eventCount() - buffer.lines);
+	}
+	writer.close(250000.0);
+
+	// assert
+	// every event starts on its own line, so lines in the stream show how many events the writer still holds back
+	EXPECT_GE(writer.eventCount(), 750000u);
+	EXPECT_EQ(buffer.lines, writer.eventCount() + 2);
+	EXPECT_GT(buffer.writes, 100u);
+	EXPECT_LE(buffer.largestWrite, std::size_t(1) << 17);
+	EXPECT_LT(largestPending, 2000u);
+}
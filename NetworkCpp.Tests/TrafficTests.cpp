@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "rng.h"
+#include "traffic.h"
+
+class TrafficTests : public testing::Test {
+};
+
+TEST(TrafficTests, GeneratorShouldBeReproducibleForSameSeed) {
+	// arrange
+	auto first = rng::Xoshiro256x4(42);
+	auto second = rng::Xoshiro256x4(42);
+	std::uint64_t left[37], right[37];
+
+	// act
+	first.fill(left, 37);
+	second.fill(right, 37);
+
+	// assert
+	for (auto i = 0; i < 37; i++) {
+		EXPECT_EQ(left[i], right[i]);
+	}
+}
+
+TEST(TrafficTests, UnitValuesShouldBeInHalfOpenInterval) {
+	// arrange
+	auto generator = rng::Xoshiro256x4(7);
+	std::vector<double> values(10000);
+
+	// act
+	generator.fillUnit(values.data(), values.size());
+
+	// assert
+	for (auto value : values) {
+		EXPECT_GT(value, 0.0);
+		EXPECT_LE(value, 1.0);
+	}
+}
+
+TEST(TrafficTests, PoissonArrivalsShouldHaveRequestedRate) {
+	// arrange
+	auto generator = traffic::TrafficGenerator(16, std::make_shared<traffic::PoissonArrivals>(250.0),
+		std::make_shared<traffic::ConstantSize>(64), 1);
+	std::vector<traffic::Arrival> arrivals;
+
+	// act
+	generator.generate(arrivals, 200000);
+
+	// assert
+	EXPECT_NEAR(arrivals.size() / arrivals.back().time, 250.0, 5.0);
+}
+
+TEST(TrafficTests, ParetoArrivalsShouldHaveRequestedRate) {
+	// arrange
+	auto generator = traffic::TrafficGenerator(16, std::make_shared<traffic::ParetoArrivals>(250.0, 2.5),
+		std::make_shared<traffic::ConstantSize>(64), 1);
+	std::vector<traffic::Arrival> arrivals;
+
+	// act
+	generator.generate(arrivals, 200000);
+
+	// assert
+	auto shortest = arrivals.front().time;
+	for (std::size_t i = 1; i < arrivals.size(); i++) {
+		shortest = std::min(shortest, arrivals[i].time - arrivals[i - 1].time);
+	}
+	EXPECT_NEAR(arrivals.size() / arrivals.back().time, 250.0, 10.0);
+	EXPECT_GE(shortest, 1.5 / (2.5 * 250.0) * (1 - 1e-9));
+	EXPECT_THROW(traffic::ParetoArrivals(250.0, 1.0), std::invalid_argument);
+}
+
+TEST(TrafficTests, ArrivalsShouldBeOrderedAndTargetOtherNodes) {
+	// arrange
+	auto generator = traffic::TrafficGenerator(5, std::make_shared<traffic::OnOffArrivals>(100.0, 0.5, 2.0),
+		std::make_shared<traffic::UniformSize>(10, 20), 3);
+	std::vector<traffic::Arrival> arrivals;
+
+	// act
+	generator.generate(arrivals, 5000);
+
+	// assert
+	for (std::size_t i = 0; i < arrivals.size(); i++) {
+		EXPECT_LT(arrivals[i].source, 5u);
+		EXPECT_LT(arrivals[i].destination, 5u);
+		EXPECT_NE(arrivals[i].source, arrivals[i].destination);
+		EXPECT_GE(arrivals[i].size, 10);
+		EXPECT_LE(arrivals[i].size, 20);
+		if (i > 0) {
+			EXPECT_GE(arrivals[i].time, arrivals[i - 1].time);
+		}
+	}
+}
+
+TEST(TrafficTests, TraceArrivalsShouldReplayTimestamps) {
+	// arrange
+	auto generator = traffic::TrafficGenerator(2, std::make_shared<traffic::TraceArrivals>(std::vector<double>{ 0.5, 1.0, 1.5 }, 2.0),
+		std::make_shared<traffic::ConstantSize>(1), 1);
+	std::vector<traffic::Arrival> arrivals;
+
+	// act
+	generator.generate(arrivals, 5);
+
+	// assert
+	ASSERT_EQ(arrivals.size(), 5u);
+	EXPECT_DOUBLE_EQ(arrivals[2].time, 1.5);
+	EXPECT_DOUBLE_EQ(arrivals[3].time, 2.5);
+	EXPECT_DOUBLE_EQ(arrivals[4].time, 3.0);
+}
+
+TEST(TrafficTests, FiniteTraceShouldStopGeneration) {
+	// arrange
+	auto generator = traffic::TrafficGenerator(2, std::make_shared<traffic::TraceArrivals>(std::vector<double>{ 1.0, 2.0 }),
+		std::make_shared<traffic::ConstantSize>(1), 1);
+	std::vector<traffic::Arrival> arrivals;
+
+	// act
+	auto result = generator.generate(arrivals, 10);
+
+	// assert
+	EXPECT_EQ(result, 2u);
+	EXPECT_EQ(arrivals.size(), 2u);
+}
+
+TEST(TrafficTests, EmpiricalSizesShouldOnlyUseGivenValues) {
+	// arrange
+	auto sizes = traffic::EmpiricalSize({ 64, 1500 }, { 0.0, 1.0 });
+	auto generator = rng::Xoshiro256x4(9);
+	int result[100];
+
+	// act
+	sizes.next(generator, result, 100);
+
+	// assert
+	for (auto size : result) {
+		EXPECT_EQ(size, 1500);
+	}
+}
+
+TEST(TrafficTests, EmpiricalSizesShouldRejectZeroWeights) {
+	// arrange
+	// act
+	// assert
+	EXPECT_THROW(traffic::EmpiricalSize({ 64, 1500 }, { 0.0, 0.0 }), std::invalid_argument);
+	EXPECT_THROW(traffic::EmpiricalSize({ 64, 1500 }, { 1.0, -1.0 }), std::invalid_argument);
+}
+
+TEST(TrafficTests, ParetoSizesShouldFollowPowerLawTail) {
+	// arrange
+	auto sizes = traffic::ParetoSize(100, 1.5, 10000);
+	auto generator = rng::Xoshiro256x4(11);
+	std::vector<int> result(200000);
+
+	// act
+	sizes.next(generator, result.data(), result.size());
+
+	// assert
+	std::size_t above = 0;
+	for (auto size : result) {
+		EXPECT_GE(size, 100);
+		EXPECT_LE(size, 10000);
+		above += size >= 400 ? 1 : 0;
+	}
+	EXPECT_NEAR(static_cast<double>(above) / result.size(), 0.125, 0.005);
+}
+
+TEST(TrafficTests, DeliverShouldEnqueueIntoSenderBuffer) {
+	// arrange
+	std::vector<entities::Node> nodes(3);
+	traffic::Arrival arrivals[] = { { 0.1, 0, 2, 100 }, { 0.2, 0, 1, 200 }, { 0.3, 2, 1, 300 } };
+
+	// act
+	traffic::TrafficGenerator::deliver(arrivals, 3, nodes);
+
+	// assert
+	EXPECT_EQ(nodes[0].buffer().count(), 2);
+	EXPECT_EQ(nodes[1].buffer().count(), 0);
+	EXPECT_EQ(nodes[2].buffer().count(), 1);
+	EXPECT_EQ(nodes[0].buffer()[0].receiver(), nodes[2]);
+	EXPECT_EQ(nodes[2].buffer()[0].size(), 300);
+}
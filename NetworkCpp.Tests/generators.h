@@ -31,13 +31,11 @@ namespace generators {
 	public:
 		MessageGenerator();
 
-		~MessageGenerator() override;
-
 		entities::Message							Generate() override;
 	private:
-		Generator<entities::Node>*					m_nodeGenerator;
-		boost::random::mt19937*						m_rng;
-		boost::random::uniform_int_distribution<>*	m_distribution;
+		NodeGenerator								m_nodeGenerator;
+		boost::random::mt19937						m_rng;
+		boost::random::uniform_int_distribution<>	m_distribution;
 	};
 }
 